@@ -1,125 +1,176 @@
 #include "array.h"
 #include <cstdlib> // For malloc, free
-#include <new>     // For placement new
-#include <algorithm> // For std::min
+#include <cstring> // For memcpy
+#include <new>     // For placement new, std::bad_alloc
 
 // Class constructor
 array_t::array_t() :
-ptr(0),
-num_elements(0),
-array_size(0) {
+chunks(0),
+num_chunks(0),
+dir_size(0),
+num_elements(0) {
 // Nothing to do
 }
 
 /**
- * @brief Constructs an array_t by performing a deep copy of the source array.
+ * @brief Constructs an array_t sharing the chunks of the source array.
  * @param m_array The source array_t instance to copy from.
+ *
+ * Only the directory is copied, and every chunk holding elements gains a
+ * reference. The elements are copied later, one chunk at a time, when
+ * either array changes them.
  */
 array_t::array_t(const array_t& m_array) :
-ptr(0),
-num_elements(0),
-array_size(0) {
-    if (m_array.array_size > 0) {
-        // 1. Allocate raw memory space using malloc().
-        ptr = (data_t*)malloc(sizeof(data_t) * m_array.array_size);
-        if (ptr == nullptr) {
-            // Handle allocation failure if necessary, though typical for assignments is to assume success.
+chunks(0),
+num_chunks(0),
+dir_size(0),
+num_elements(0) {
+    const size_t used = (m_array.num_elements + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    if (used > 0) {
+        grow_directory(used);
+        for (size_t i = 0; i < used; ++i) {
+            m_array.chunks[i]->refs.fetch_add(1, std::memory_order_relaxed);
+            chunks[i] = m_array.chunks[i];
         }
+        num_chunks = used;
+        num_elements = m_array.num_elements;
+    }
+}
 
-        // 2. Deep copy elements using placement new (copy constructor of data_t).
-        for (size_t i = 0; i < m_array.num_elements; ++i) {
-            new (&ptr[i]) data_t(m_array.ptr[i]);
-        }
+/**
+ * @brief Constructs an array_t by taking over the storage of the source array.
+ * @param m_array The source array_t instance, left empty.
+ */
+array_t::array_t(array_t&& m_array) noexcept :
+chunks(m_array.chunks),
+num_chunks(m_array.num_chunks),
+dir_size(m_array.dir_size),
+num_elements(m_array.num_elements) {
+    m_array.chunks = 0;
+    m_array.num_chunks = 0;
+    m_array.dir_size = 0;
+    m_array.num_elements = 0;
+}
 
-        // 3. Update metadata.
+/**
+ * @brief Releases the current elements and takes over the storage of the source array.
+ * @param m_array The source array_t instance, left empty.
+ */
+array_t& array_t::operator=(array_t&& m_array) noexcept {
+    if (this != &m_array) {
+        for (size_t i = 0; i < num_chunks; ++i) {
+            release(chunks[i]);
+        }
+        free(chunks);
+        chunks = m_array.chunks;
+        num_chunks = m_array.num_chunks;
+        dir_size = m_array.dir_size;
         num_elements = m_array.num_elements;
-        array_size = m_array.array_size;
+        m_array.chunks = 0;
+        m_array.num_chunks = 0;
+        m_array.dir_size = 0;
+        m_array.num_elements = 0;
     }
+    return *this;
 }
 
 /**
  * @brief Destroys the array_t instance and deallocates memory.
  *
- * All data_t instances must be explicitly destructed before deallocating the raw memory.
+ * Every chunk loses a reference, and the last array sharing a chunk
+ * destroys its elements.
  */
 array_t::~array_t() {
-    if (ptr != nullptr) {
-        // Explicitly call the destructor for each constructed element.
-        for (size_t i = 0; i < num_elements; ++i) {
-            ptr[i].~data_t();
-        }
-        // Deallocate the raw memory block allocated by malloc().
-        free(ptr);
+    for (size_t i = 0; i < num_chunks; ++i) {
+        release(chunks[i]);
     }
-    // No need to reset members, as the object is being destroyed.
+    free(chunks);
 }
 
 
 /**
- * @brief Allocates a memory space for the specified number of elements.
+ * @brief Allocates chunks for the specified number of elements.
  * @param m_array_size The new capacity to reserve.
  *
- * Uses malloc/free and placement new for element copying, ensuring data_t life-cycle management.
+ * The elements stay where they are, and the new chunks are empty, so
+ * push_back() up to this capacity allocates nothing.
  */
 void array_t::reserve(const size_t m_array_size) {
-    // Only proceed if requested size is greater than current capacity.
-    if (m_array_size > array_size) {
-        // 1. Allocate new raw memory space.
-        data_t *new_ptr = (data_t*)malloc(sizeof(data_t) * m_array_size);
-        if (new_ptr == nullptr) {
-            // Error handling for memory allocation failure (e.g., throw exception or exit)
-            return;
-        }
+    const size_t needed = (m_array_size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    grow_directory(needed);
+    while (num_chunks < needed) { add_chunk(); }
+}
 
-        // 2. Copy elements from old array to new array using data_t's copy constructor (Placement New).
-        // Only copy up to the minimum of the old element count and the new size (though new size is > old capacity,
-        // we only copy 'num_elements').
-        for (size_t i = 0; i < num_elements; ++i) {
-            new (&new_ptr[i]) data_t(ptr[i]);
-        }
+/**
+ * @brief Grows the directory to hold the specified number of chunk pointers.
+ * @param m_num_chunks The new size of the directory.
+ *
+ * Only the chunk pointers move to the new directory.
+ */
+void array_t::grow_directory(const size_t m_num_chunks) {
+    // Only proceed if requested size is greater than current directory.
+    if (m_num_chunks > dir_size) {
+        chunk_t **new_chunks = (chunk_t**)malloc(sizeof(chunk_t*) * m_num_chunks);
+        if (new_chunks == nullptr) { throw std::bad_alloc(); }
+        if (num_chunks > 0) { memcpy(new_chunks, chunks, sizeof(chunk_t*) * num_chunks); }
+        free(chunks);
+        chunks = new_chunks;
+        dir_size = m_num_chunks;
+    }
+}
 
-        // 3. Handle old memory block.
-        if (ptr != nullptr) {
-            // Explicitly call the destructor for elements in the old block.
-            for (size_t i = 0; i < num_elements; ++i) {
-                ptr[i].~data_t();
-            }
-            // Deallocate the old raw memory block.
-            free(ptr);
-        }
+/**
+ * @brief Gets a chunk this array may change.
+ * @param m_chunk The index of the chunk in the directory.
+ * @return The chunk, owned by this array alone.
+ *
+ * A shared chunk is replaced by a private copy of its elements, and the
+ * other arrays keep the original.
+ */
+array_t::chunk_t* array_t::own(const size_t m_chunk) {
+    chunk_t *chunk = chunks[m_chunk];
+    if (chunk->refs.load(std::memory_order_acquire) == 1) { return chunk; }
 
-        // 4. Update member variables.
-        ptr = new_ptr;
-        array_size = m_array_size;
+    void *block = malloc(sizeof(chunk_t));
+    if (block == nullptr) { throw std::bad_alloc(); }
+    chunk_t *copy = new (block) chunk_t();
+    for (; copy->count < chunk->count; ++copy->count) {
+        new (&copy->items()[copy->count]) data_t(chunk->items()[copy->count]);
     }
+    release(chunk);
+    chunks[m_chunk] = copy;
+    return copy;
 }
 
 /**
- * @brief Adds a new element at the end of the array.
- * @param m_value The data_t value to insert.
+ * @brief Adds an empty chunk at the end of the directory.
+ * @return The new chunk.
  *
- * Checks capacity and calls reserve() to double the size if full.
+ * The directory doubles when it is full.
  */
-void array_t::push_back(const data_t m_value) {
-    // 1. Check if the array is full.
-    if (num_elements == array_size) {
-        size_t new_size = array_size;
-        
-        // Determine the next capacity.
-        if (array_size == 0) {
-            new_size = 1; // Initial capacity is 1.
-        } else {
-            new_size *= 2; // Double the capacity.
-        }
-        
-        // Reserve the new capacity.
-        reserve(new_size);
+array_t::chunk_t* array_t::add_chunk() {
+    if (num_chunks == dir_size) {
+        grow_directory(dir_size == 0 ? 1 : dir_size * 2);
     }
+    void *block = malloc(sizeof(chunk_t));
+    if (block == nullptr) { throw std::bad_alloc(); }
+    chunks[num_chunks] = new (block) chunk_t();
+    return chunks[num_chunks++];
+}
 
-    // 2. Construct the new element in the reserved space using Placement New (Copy Construction).
-    // The element m_value is copied into the raw memory at index num_elements.
-    new (&ptr[num_elements]) data_t(m_value);
-
-    // 3. Update the number of elements.
-    num_elements++;
-}
\ No newline at end of file
+/**
+ * @brief Drops a reference to a chunk.
+ * @param m_chunk The chunk to release.
+ *
+ * The array dropping the last reference destroys the elements and frees
+ * the chunk. Its decrement also sees every other sharer's reads.
+ */
+void array_t::release(chunk_t *m_chunk) {
+    if (m_chunk->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        for (size_t i = 0; i < m_chunk->count; ++i) {
+            m_chunk->items()[i].~data_t();
+        }
+        m_chunk->~chunk_t();
+        free(m_chunk);
+    }
+}
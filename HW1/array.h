@@ -1,7 +1,22 @@
 #ifndef __ARRAY_H__
 #define __ARRAY_H__
+#include <atomic>
+#include <new>
+#include <utility>
 #include "string.h"
 typedef string_t data_t; // data_t represents string_t.
+
+// Elements are stored in chunks of CHUNK_SIZE, reached through a directory
+// of chunk pointers. A copy of an array shares the chunks, each of which
+// keeps an atomic reference count, and a chunk is copied only when one of
+// its sharers changes it (copy-on-write). Only the changed chunk is
+// copied, so changing one element of a large copy copies CHUNK_SIZE
+// elements. Copies may be read and destroyed on different threads; a
+// single array is changed by one thread at a time.
+// Growth never moves elements: a full array adds a chunk, and only the
+// directory of pointers is reallocated. References to elements stay
+// valid until the element is erased or its shared chunk is copied by a
+// write, and indexing is a shift and a mask into the directory.
 class array_t {
 public:
     // Class constructor
@@ -9,26 +24,84 @@ public:
     /* Assignment 1:
     Write a copy constructor and destructor of the class.
     */
-    // @brief Constructs an array_t by deep-copying another instance.
+    // @brief Constructs an array_t sharing the chunks of another instance.
     array_t(const array_t& m_array);
 
+    // @brief Constructs an array_t by taking over the storage of another instance.
+    array_t(array_t&& m_array) noexcept;
+
+    // @brief Releases the current elements and takes over the storage of another instance.
+    array_t& operator=(array_t&& m_array) noexcept;
+
     // @brief Destroys the array_t instance and deallocates memory.
     ~array_t();
 
-    // Allocate a memory space for the specified number of elements.
+    // Allocate chunks for the specified number of elements.
     void reserve(const size_t m_array_size);
     // Add a new element at the end of array.
-    void push_back(const data_t m_value);
-    // Reference operator
-    data_t& operator[](const size_t m_index) const { return ptr[m_index]; }
+    void push_back(const data_t& m_value) { emplace_back(m_value); }
+    void push_back(data_t&& m_value) { emplace_back(std::move(m_value)); }
+    // Construct a new element in place at the end of array.
+    template <typename... Args>
+    void emplace_back(Args&&... m_args);
+    // Reference operator, which first copies the element's chunk if it is shared.
+    data_t& operator[](const size_t m_index) { return own(m_index / CHUNK_SIZE)->items()[m_index % CHUNK_SIZE]; }
+    // Read-only reference operator, which never copies.
+    const data_t& operator[](const size_t m_index) const { return chunks[m_index / CHUNK_SIZE]->items()[m_index % CHUNK_SIZE]; }
     // Get the number of elements in the array.
     size_t size() const { return num_elements; }
     // Get the size of allocated memory space.
-    size_t capacity() const { return array_size; }
+    size_t capacity() const { return num_chunks * CHUNK_SIZE; }
     
 private:
-    data_t *ptr; // Pointer to an array
+    static const size_t CHUNK_SIZE = 16; // Elements per chunk
+
+    // Block of CHUNK_SIZE elements, shared by copies of an array
+    struct chunk_t {
+        chunk_t() : refs(1), count(0) { }
+        data_t* items() { return reinterpret_cast<data_t*>(storage); }
+        std::atomic<size_t> refs; // Number of arrays sharing the chunk
+        size_t count; // Number of constructed elements
+        alignas(data_t) unsigned char storage[CHUNK_SIZE * sizeof(data_t)];
+    };
+
+    // Get a chunk this array may change, copying it first if it is shared.
+    chunk_t* own(const size_t m_chunk);
+    // Add an empty chunk at the end of the directory.
+    chunk_t* add_chunk();
+    // Grow the directory to hold 'm_num_chunks' chunk pointers.
+    void grow_directory(const size_t m_num_chunks);
+    // Drop a reference to a chunk, and destroy it with the last one.
+    static void release(chunk_t *m_chunk);
+
+    chunk_t **chunks; // Directory of chunks
+    size_t num_chunks; // Number of chunks in the directory
+    size_t dir_size; // Allocated size of the directory
     size_t num_elements; // Actual number of elements in the array
-    size_t array_size; // Allocated size of array
 };
+
+/**
+ * @brief Constructs a new element at the end of the array.
+ * @param m_args Arguments forwarded to the data_t constructor.
+ *
+ * Adds a chunk if the last one is full, and copies the last chunk if it
+ * is shared. The arguments may refer to an element of this array, so in
+ * those cases the new element is built before the chunks change.
+ */
+template <typename... Args>
+void array_t::emplace_back(Args&&... m_args) {
+    const size_t index = num_elements / CHUNK_SIZE;
+    chunk_t *chunk;
+    if (index == num_chunks || chunks[index]->refs.load(std::memory_order_acquire) > 1) {
+        data_t value(std::forward<Args>(m_args)...);
+        chunk = index == num_chunks ? add_chunk() : own(index);
+        new (&chunk->items()[num_elements % CHUNK_SIZE]) data_t(std::move(value));
+    }
+    else {
+        chunk = chunks[index];
+        new (&chunk->items()[num_elements % CHUNK_SIZE]) data_t(std::forward<Args>(m_args)...);
+    }
+    chunk->count++;
+    num_elements++;
+}
 #endif
\ No newline at end of file
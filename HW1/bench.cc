@@ -0,0 +1,77 @@
+/* bench.cc */
+// Benchmarks of the HW1 array, built with "make bench".
+// "./bench [count]" pushes 'count' strings (default 2^22) one at a time
+// and reports the total time and the latency of single push_back() calls.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <utility>
+#include <vector>
+#include "array.h"
+
+using namespace std;
+
+// Contiguous array that doubles its capacity and moves every element to
+// the new block when full, as array_t did before it was segmented
+class doubling_array_t {
+public:
+    doubling_array_t() : ptr(0), num_elements(0), array_size(0) { }
+    ~doubling_array_t() {
+        for (size_t i = 0; i < num_elements; ++i) { ptr[i].~data_t(); }
+        free(ptr);
+    }
+    void reserve(const size_t m_array_size) {
+        if (m_array_size <= array_size) { return; }
+        data_t *new_ptr = (data_t*)malloc(sizeof(data_t) * m_array_size);
+        for (size_t i = 0; i < num_elements; ++i) {
+            new (&new_ptr[i]) data_t(move_if_noexcept(ptr[i]));
+            ptr[i].~data_t();
+        }
+        free(ptr);
+        ptr = new_ptr;
+        array_size = m_array_size;
+    }
+    void push_back(const char *m_value) {
+        if (num_elements == array_size) { reserve(array_size == 0 ? 1 : array_size * 2); }
+        new (&ptr[num_elements++]) data_t(m_value);
+    }
+
+private:
+    data_t *ptr;
+    size_t num_elements;
+    size_t array_size;
+};
+
+// Push 'm_count' strings, timing each push_back(), and print the total
+// time, the 99.9th percentile and the worst case.
+template <typename Array>
+static void push_latency(const char *m_name, const size_t m_count, const bool m_reserve) {
+    vector<long> nsec(m_count);
+    Array *array = new Array;
+    auto start = chrono::steady_clock::now();
+    if (m_reserve) { array->reserve(m_count); }
+    for (size_t i = 0; i < m_count; ++i) {
+        auto before = chrono::steady_clock::now();
+        array->push_back("a word");
+        nsec[i] = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - before).count();
+    }
+    double msec = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    delete array;
+    sort(nsec.begin(), nsec.end());
+    cout << m_name << (m_reserve ? "_reserved" : "") << ": " << msec << " msec, p99.9 "
+         << nsec[m_count - 1 - m_count / 1000] << " nsec, max " << nsec[m_count - 1] / 1000.0
+         << " usec per push_back (" << m_count << " elements)" << endl;
+}
+
+int main(int argc, char **argv) {
+    const size_t count = argc > 1 ? strtoul(argv[1], 0, 10) : 1 << 22;
+    if (!count) { cerr << "Usage: " << argv[0] << " [count]" << endl; exit(1); }
+    push_latency<doubling_array_t>("doubling", count, false);
+    push_latency<array_t>("segmented", count, false);
+    push_latency<doubling_array_t>("doubling", count, true);
+    push_latency<array_t>("segmented", count, true);
+    return 0;
+}
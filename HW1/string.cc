@@ -1,40 +1,101 @@
 #include <cstdlib>
 #include <cstring>
+#include <new>
 #include "string.h"
 
 // Minimal implementation of string
-string_t::string_t() : ptr(0), length(0) {
+string_t::string_t() : length(0) {
+    buffer[0] = 0;
 }
 
+// A long string shares the heap buffer, and a short one is copied.
 string_t::string_t(const string_t &m_string) :
-    length(m_string.length) {
-    ptr = (char*)malloc(length+1);
-    strcpy(ptr, m_string.ptr);
+    length(0) {
+    if(m_string.length > SSO_SIZE) {
+        refs(m_string.ptr).fetch_add(1, std::memory_order_relaxed);
+        ptr = m_string.ptr;
+        length = m_string.length;
+    }
+    else { assign(m_string.data(), m_string.length); }
 }
 
 string_t::string_t(const char *m_char) :
-    length(strlen(m_char)) {
-    ptr = (char*)malloc(length+1);
-    strcpy(ptr, m_char);
+    length(0) {
+    assign(m_char, strlen(m_char));
+}
+
+// A long string hands over its heap buffer, and a short one is copied.
+string_t::string_t(string_t &&m_string) noexcept {
+    steal(m_string);
 }
 
 string_t::~string_t() {
-    free(ptr);
+    if(length > SSO_SIZE) { release(ptr); }
 }
 
+// The heap buffer of 'm_string' gains a reference before the old one is
+// dropped, so the two may be the same.
 string_t& string_t::operator=(const string_t &m_string) {
-    free(ptr);
-    length = m_string.length;
-    ptr = (char*)malloc(length+1);
-    strcpy(ptr, m_string.ptr);
+    if(&m_string == this) { return *this; }
+    if(m_string.length > SSO_SIZE) {
+        refs(m_string.ptr).fetch_add(1, std::memory_order_relaxed);
+        if(length > SSO_SIZE) { release(ptr); }
+        ptr = m_string.ptr;
+        length = m_string.length;
+    }
+    else { assign(m_string.data(), m_string.length); }
     return *this;
 }
 
 string_t& string_t::operator=(const char *m_char) {
-    free(ptr);
-    length = strlen(m_char);
-    ptr = (char*)malloc(length+1);
-    strcpy(ptr, m_char);
+    assign(m_char, strlen(m_char));
     return *this;
 }
 
+string_t& string_t::operator=(string_t &&m_string) noexcept {
+    if(&m_string != this) {
+        if(length > SSO_SIZE) { release(ptr); }
+        steal(m_string);
+    }
+    return *this;
+}
+
+// Short strings go to the inline buffer, and long ones to a new heap
+// buffer. The old heap buffer is released last, so 'm_char' may point
+// into this string.
+void string_t::assign(const char *m_char, const size_t m_length) {
+    char *old = length > SSO_SIZE ? ptr : 0;
+    if(m_length > SSO_SIZE) {
+        char *heap = acquire(m_length);
+        memcpy(heap, m_char, m_length);
+        heap[m_length] = 0;
+        ptr = heap;
+    }
+    else {
+        memmove(buffer, m_char, m_length);
+        buffer[m_length] = 0;
+    }
+    length = m_length;
+    if(old) { release(old); }
+}
+
+void string_t::steal(string_t &m_string) noexcept {
+    memcpy(buffer, m_string.buffer, sizeof(buffer));
+    length = m_string.length;
+    m_string.buffer[0] = 0;
+    m_string.length = 0;
+}
+
+char* string_t::acquire(const size_t m_length) {
+    void *block = malloc(sizeof(std::atomic<size_t>) + m_length + 1);
+    if(!block) { throw std::bad_alloc(); }
+    return (char*)(new (block) std::atomic<size_t>(1) + 1);
+}
+
+// The decrement that reaches zero also sees every other owner's reads.
+void string_t::release(char *m_ptr) {
+    if(refs(m_ptr).fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        refs(m_ptr).~atomic();
+        free(reinterpret_cast<std::atomic<size_t>*>(m_ptr) - 1);
+    }
+}
@@ -1,25 +1,51 @@
+#include <atomic>
 #include <iostream>
 
 // Minimal implementation of string
+// Strings of up to SSO_SIZE characters are stored inside the object
+// (small-string optimization), so only longer ones allocate a heap buffer.
+// A heap buffer starts with an atomic reference count, and copies of a
+// long string share it instead of copying the characters. The characters
+// are never changed in place, so a shared buffer needs no private copy;
+// assignment points the string to a new buffer and drops the old one.
 class string_t {
 public:
     string_t();
     string_t(const string_t &m_string);
     string_t(const char *m_char);
+    string_t(string_t &&m_string) noexcept;
     ~string_t();
 
     string_t& operator=(const string_t &m_string);
     string_t& operator=(const char *m_char);
+    string_t& operator=(string_t &&m_string) noexcept;
     size_t size() const { return length; }
 
 private:
-    char *ptr;
+    // Pointer to the characters, inline or on the heap
+    const char* data() const { return length > SSO_SIZE ? ptr : buffer; }
+    // Replace the contents with 'm_length' characters from 'm_char'.
+    void assign(const char *m_char, const size_t m_length);
+    // Take over the contents of 'm_string', leaving it empty.
+    void steal(string_t &m_string) noexcept;
+    // Reference count in front of the characters of a heap buffer
+    static std::atomic<size_t>& refs(char *m_ptr) { return *(reinterpret_cast<std::atomic<size_t>*>(m_ptr) - 1); }
+    // Allocate a heap buffer for 'm_length' characters with one reference.
+    static char* acquire(const size_t m_length);
+    // Drop a reference to a heap buffer, and free it with the last one.
+    static void release(char *m_ptr);
+
+    static const size_t SSO_SIZE = 15;  // Longest string stored inline
+    union {
+        char *ptr;                      // Heap buffer of a long string
+        char buffer[SSO_SIZE + 1];      // Inline characters of a short string
+    };
     size_t length;
 
 friend std::ostream& operator<<(std::ostream &m_os, const string_t &m_string);
 };
 
 inline std::ostream& operator<<(std::ostream &m_os, const string_t &m_string) {
-    return m_os << m_string.ptr;
+    return m_os << m_string.data();
 }
 
@@ -0,0 +1,167 @@
+/* allocator.h */
+#ifndef __ALLOCATOR_H__
+#define __ALLOCATOR_H__
+
+#include <cstddef> // size_t, max_align_t
+#include <cstdlib> // malloc, free, realloc
+#include <cstring> // memcpy
+#include <new>     // bad_alloc
+
+// ---------------------------------------------------------------------
+// Memory Resources
+// A memory resource hands out raw memory. The caller passes the size back
+// on deallocation, so resources need no per-block headers.
+// ---------------------------------------------------------------------
+class memory_resource_t {
+public:
+    virtual ~memory_resource_t() { }
+    // Allocate 'm_bytes', aligned for any fundamental type.
+    virtual void* allocate(const size_t m_bytes) = 0;
+    // Release a block of 'm_bytes' from allocate().
+    virtual void deallocate(void *m_ptr, const size_t m_bytes) = 0;
+    // Resize a block, keeping its first min(m_old_bytes, m_new_bytes) bytes.
+    virtual void* reallocate(void *m_ptr, const size_t m_old_bytes, const size_t m_new_bytes) {
+        void *ptr = allocate(m_new_bytes);
+        if(m_ptr) {
+            memcpy(ptr, m_ptr, m_old_bytes < m_new_bytes ? m_old_bytes : m_new_bytes);
+            deallocate(m_ptr, m_old_bytes);
+        }
+        return ptr;
+    }
+};
+
+// Monotonic bump allocator
+// Blocks are carved from chunks that double in size up to CHUNK_MAX, and
+// memory comes back only when the whole arena is released, in O(chunks).
+// Only the most recent block can shrink, grow in place or be given back.
+class arena_t : public memory_resource_t {
+public:
+    arena_t() : chunk(0), top(0), limit(0), last(0), next_size(CHUNK_MIN) { }
+    ~arena_t() { release(); }
+    arena_t(const arena_t &m_arena) = delete;
+    arena_t& operator=(const arena_t &m_arena) = delete;
+
+    void* allocate(const size_t m_bytes) {
+        const size_t bytes = round(m_bytes);
+        if((size_t)(limit - top) < bytes) { grow(bytes); }
+        last = top;
+        top += bytes;
+        return last;
+    }
+    void deallocate(void *m_ptr, const size_t m_bytes) {
+        if(m_ptr && (m_ptr == last)) { top = last; last = 0; }
+    }
+    void* reallocate(void *m_ptr, const size_t m_old_bytes, const size_t m_new_bytes) {
+        if(m_ptr && (m_ptr == last) && ((size_t)(limit - last) >= round(m_new_bytes))) {
+            top = last + round(m_new_bytes);
+            return m_ptr;
+        }
+        return memory_resource_t::reallocate(m_ptr, m_old_bytes, m_new_bytes);
+    }
+    // Free every chunk at once.
+    void release(void) {
+        while(chunk) { chunk_t *prev = chunk->prev; free(chunk); chunk = prev; }
+        top = limit = last = 0;
+        next_size = CHUNK_MIN;
+    }
+
+private:
+    static const size_t ALIGN = alignof(std::max_align_t);
+    static const size_t CHUNK_MIN = 1 << 12, CHUNK_MAX = 1 << 20;
+    struct alignas(std::max_align_t) chunk_t { chunk_t *prev; };
+
+    static size_t round(const size_t m_bytes) { return (m_bytes + ALIGN - 1) / ALIGN * ALIGN; }
+    void grow(const size_t m_bytes) {
+        size_t size = next_size > m_bytes ? next_size : m_bytes;
+        chunk_t *next = (chunk_t*)malloc(sizeof(chunk_t) + size);
+        if(!next) { throw std::bad_alloc(); }
+        next->prev = chunk;
+        chunk = next;
+        top = (char*)(chunk + 1);
+        limit = top + size;
+        if(next_size < CHUNK_MAX) { next_size *= 2; }
+    }
+
+    chunk_t *chunk;         // Most recent chunk, linked to the older ones
+    char *top, *limit;      // Free space of the most recent chunk
+    char *last;             // Most recent block
+    size_t next_size;       // Size of the next chunk
+};
+
+// Size-class pool allocator
+// Blocks of up to CLASS_MAX bytes are rounded up to a power of two and
+// recycled through per-class free lists, refilled from an arena. Larger
+// blocks go to malloc(). Releasing the pool frees all small blocks at once.
+class pool_t : public memory_resource_t {
+public:
+    pool_t() { for(size_t c = 0; c < NUM_CLASSES; c++) { free_list[c] = 0; } }
+    pool_t(const pool_t &m_pool) = delete;
+    pool_t& operator=(const pool_t &m_pool) = delete;
+
+    void* allocate(const size_t m_bytes) {
+        if(m_bytes > CLASS_MAX) {
+            void *ptr = malloc(m_bytes);
+            if(!ptr) { throw std::bad_alloc(); }
+            return ptr;
+        }
+        const size_t c = size_class(m_bytes);
+        if(!free_list[c]) { return arena.allocate(CLASS_MIN << c); }
+        node_t *node = free_list[c];
+        free_list[c] = node->next;
+        return node;
+    }
+    void deallocate(void *m_ptr, const size_t m_bytes) {
+        if(!m_ptr) { return; }
+        if(m_bytes > CLASS_MAX) { free(m_ptr); return; }
+        const size_t c = size_class(m_bytes);
+        node_t *node = (node_t*)m_ptr;
+        node->next = free_list[c];
+        free_list[c] = node;
+    }
+    // Free all small blocks at once. Large blocks must be deallocated one by one.
+    void release(void) {
+        arena.release();
+        for(size_t c = 0; c < NUM_CLASSES; c++) { free_list[c] = 0; }
+    }
+
+private:
+    static const size_t CLASS_MIN = 16, CLASS_MAX = 1024, NUM_CLASSES = 7;
+    struct node_t { node_t *next; };
+
+    // Index of the smallest class holding 'm_bytes'
+    static size_t size_class(const size_t m_bytes) {
+        size_t c = 0;
+        while((CLASS_MIN << c) < m_bytes) { c++; }
+        return c;
+    }
+
+    arena_t arena;                      // Source of small blocks
+    node_t *free_list[NUM_CLASSES];     // Recycled blocks of each class
+};
+
+// ---------------------------------------------------------------------
+// Allocators
+// Containers take an allocator by value. malloc_allocator_t is the plain
+// heap, and resource_allocator_t is a handle to a memory resource.
+// ---------------------------------------------------------------------
+struct malloc_allocator_t {
+    void* allocate(const size_t m_bytes) const { return malloc(m_bytes); }
+    void deallocate(void *m_ptr, const size_t) const { free(m_ptr); }
+    void* reallocate(void *m_ptr, const size_t, const size_t m_new_bytes) const { return realloc(m_ptr, m_new_bytes); }
+    // The memory resource of this allocator (null for the heap)
+    memory_resource_t* resource(void) const { return 0; }
+};
+
+struct resource_allocator_t {
+    resource_allocator_t(memory_resource_t *m_resource = 0) : res(m_resource) { }
+    void* allocate(const size_t m_bytes) const { return res->allocate(m_bytes); }
+    void deallocate(void *m_ptr, const size_t m_bytes) const { res->deallocate(m_ptr, m_bytes); }
+    void* reallocate(void *m_ptr, const size_t m_old_bytes, const size_t m_new_bytes) const {
+        return res->reallocate(m_ptr, m_old_bytes, m_new_bytes);
+    }
+    memory_resource_t* resource(void) const { return res; }
+
+    memory_resource_t *res;
+};
+
+#endif
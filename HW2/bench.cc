@@ -0,0 +1,454 @@
+/* bench.cc */
+// Benchmarks of the HW2 containers, built with "make bench".
+// "./bench [input_file] [name...]" runs the named benchmarks, or all of them.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
+#include "flat.h"
+#include "hash.h"
+#include "string.h"
+#include "string_column.h"
+#include "vector.h"
+#include "word_file.h"
+
+#define WORD_SIZE 16
+
+using namespace std;
+
+// Count every heap allocation, including those made by operator new and other threads.
+static atomic<size_t> malloc_calls(0);
+extern "C" void* __libc_malloc(size_t);
+extern "C" void* __libc_calloc(size_t, size_t);
+extern "C" void* __libc_realloc(void*, size_t);
+extern "C" void* malloc(size_t m_size) { malloc_calls++; return __libc_malloc(m_size); }
+extern "C" void* calloc(size_t m_num, size_t m_size) { malloc_calls++; return __libc_calloc(m_num, m_size); }
+extern "C" void* realloc(void *m_ptr, size_t m_size) { malloc_calls++; return __libc_realloc(m_ptr, m_size); }
+
+// Measures the wall time and heap allocations of one benchmark.
+class probe_t {
+public:
+    probe_t(const char *m_name) : name(m_name), calls(malloc_calls), start(chrono::steady_clock::now()) { }
+    void report(const size_t m_iterations = 1) {
+        double msec = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        cout << name << ": " << msec << " msec, " << (malloc_calls - calls) / (double)m_iterations
+             << " mallocs per iteration (" << m_iterations << " iterations)" << endl;
+    }
+
+private:
+    const char *name;
+    size_t calls;
+    chrono::steady_clock::time_point start;
+};
+
+// Input words, read once with the same WORD_SIZE cap as main.cc
+static char (*lines)[WORD_SIZE] = 0;
+static size_t num_lines = 0;
+
+static void load(const char *m_file) {
+    ifstream input_file(m_file);
+    if(!input_file.is_open()) { cerr << "Error: failed to open " << m_file << endl; exit(1); }
+    size_t capacity = 0;
+    char line[WORD_SIZE];
+    while(input_file.getline(line, WORD_SIZE)) {
+        if(num_lines == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            lines = (char(*)[WORD_SIZE])realloc(lines, capacity * WORD_SIZE);
+        }
+        strcpy(lines[num_lines++], line);
+    }
+}
+
+// The main.cc workflow without printing: push, filter vowels, sorted insert, pop 'z', clear, copy.
+static void workflow(void) {
+    vector_t<string_t> words, sorted;
+    for(size_t i = 0; i < num_lines; i++) { words.push_back(lines[i]); }
+    words.erase_if([](const string_t &m_word) {
+        return (m_word[0] == 'a') || (m_word[0] == 'e') || (m_word[0] == 'i') ||
+               (m_word[0] == 'o') || (m_word[0] == 'u'); });
+    sorted.reserve(words.size());
+    for(size_t i = 0; i < words.size(); i++) {
+        sorted.insert(lower_bound(sorted.begin(), sorted.end(), words[i]), words[i]);
+    }
+    while(sorted.size() && (sorted[sorted.size()-1][0] == 'z')) { sorted.pop_back(); }
+    sorted.clear();
+    words = sorted;
+}
+
+static void bench_workflow(void) {
+    const size_t iterations = 2000;
+    probe_t probe("workflow");
+    for(size_t i = 0; i < iterations; i++) { workflow(); }
+    probe.report(iterations);
+}
+
+// Growth and shifting of long (heap-allocated) strings. Only the
+// vector buffers and the strings themselves should allocate.
+static void bench_relocate(void) {
+    const size_t count = 1 << 16, shifts = 256;
+    vector_t<string_t> words;
+    const string_t word("a string too long for the inline buffer");
+    probe_t probe("relocate");
+    for(size_t i = 0; i < count; i++) { words.push_back(word); }
+    for(size_t i = 0; i < shifts; i++) { words.erase(words.insert(words.begin(), word)); }
+    probe.report();
+}
+
+// Growth and shifting of ints, which relocate with realloc and memmove.
+static void bench_shift(void) {
+    const size_t count = 1 << 20, shifts = 256;
+    vector_t<int> numbers;
+    probe_t probe("shift");
+    for(size_t i = 0; i < count; i++) { numbers.push_back(i); }
+    for(size_t i = 0; i < shifts; i++) { numbers.erase(numbers.insert(numbers.begin(), i)); }
+    probe.report();
+}
+
+// Numbered words, every fourth one too long for the inline buffer
+static void make_words(vector_t<string_t> &m_words, const size_t m_count) {
+    char word[64];
+    m_words.reserve(m_count);
+    for(size_t i = 0; i < m_count; i++) {
+        snprintf(word, sizeof(word), i % 4 ? "w%zu" : "long word number %zu", i);
+        m_words.emplace_back(word);
+    }
+}
+
+// Deletes about half of the words, chosen by a hash of the characters
+static bool doomed(const string_t &m_word) {
+    unsigned hash = 0;
+    for(size_t i = 0; m_word[i]; i++) { hash = (hash ^ (unsigned char)m_word[i]) * 16777619u; }
+    return (hash >> 16) & 1;
+}
+
+// One-pass compaction of 2^20 strings
+static void bench_erase_if(void) {
+    vector_t<string_t> words;
+    make_words(words, 1 << 20);
+    probe_t probe("erase_if");
+    size_t erased = words.erase_if(doomed);
+    probe.report();
+    cout << "  erased " << erased << " of " << erased + words.size() << endl;
+}
+
+// The same filter with one erase per match, on 2^15 strings
+static void bench_erase_loop(void) {
+    vector_t<string_t> words;
+    make_words(words, 1 << 15);
+    probe_t probe("erase_loop");
+    size_t erased = 0;
+    for(vector_t<string_t>::iterator it = words.begin(); it != words.end(); ) {
+        if(doomed(*it)) { it = words.erase(it); erased++; }
+        else { it++; }
+    }
+    probe.report();
+    cout << "  erased " << erased << " of " << erased + words.size() << endl;
+}
+
+// Sorted insertion of shuffled strings, one insert() each as in main.cc, on 2^16 strings
+static void bench_sorted_insert(void) {
+    vector_t<string_t> words, sorted;
+    make_words(words, 1 << 16);
+    shuffle(words.begin(), words.end(), mt19937(1));
+    probe_t probe("sorted_insert");
+    sorted.reserve(words.size());
+    for(size_t i = 0; i < words.size(); i++) {
+        sorted.insert(lower_bound(sorted.begin(), sorted.end(), words[i]), words[i]);
+    }
+    probe.report();
+}
+
+// Bulk build and batched merge of a flat_set_t of 2^20 shuffled strings
+static void bench_flat_build(void) {
+    vector_t<string_t> words;
+    make_words(words, 1 << 20);
+    shuffle(words.begin(), words.end(), mt19937(1));
+    {
+        flat_set_t<string_t> set;
+        probe_t probe("flat_build");
+        set.build(words.begin(), words.end());
+        probe.report();
+    }
+    {
+        flat_set_t<string_t> set;
+        const size_t batch = 1 << 16;
+        probe_t probe("flat_insert_many");
+        for(size_t i = 0; i < words.size(); i += batch) {
+            set.insert_many(words.begin() + i, words.begin() + i + batch);
+        }
+        probe.report();
+    }
+}
+
+// Random lookups in a flat_set_t of 2^22 ints with each layout
+static void bench_flat_lookup(void) {
+    const size_t count = 1 << 22, lookups = 1 << 22;
+    vector_t<int> numbers;
+    numbers.reserve(count);
+    for(size_t i = 0; i < count; i++) { numbers.push_back(2 * i); }
+    flat_set_t<int> set;
+    set.build(numbers.begin(), numbers.end());
+    const flat_layout layouts[] = { flat_sorted, flat_eytzinger };
+    const char *names[] = { "flat_lookup_sorted", "flat_lookup_eytzinger" };
+    for(size_t l = 0; l < 2; l++) {
+        set.set_layout(layouts[l]);
+        mt19937 random(1);
+        size_t found = 0;
+        probe_t probe(names[l]);
+        for(size_t i = 0; i < lookups; i++) { found += set.contains(random() % (2 * count)); }
+        probe.report();
+        cout << "  found " << found << " of " << lookups << endl;
+    }
+}
+
+// Load and tear down 2^20 strings, half of them long, with the given allocator
+template <typename Alloc>
+static void alloc_words(const char *m_name, const Alloc &m_alloc, void (*m_release)(memory_resource_t*)) {
+    const size_t count = 1 << 20;
+    char word[64], name[64];
+    memory_resource_t *resource = m_alloc.resource();
+    vector_t<string_t, Alloc> *words = new vector_t<string_t, Alloc>(m_alloc);
+    snprintf(name, sizeof(name), "%s_load", m_name);
+    probe_t load(name);
+    for(size_t i = 0; i < count; i++) {
+        snprintf(word, sizeof(word), i % 2 ? "w%zu" : "long word number %zu", i);
+        words->emplace_back(word, resource);
+    }
+    load.report();
+    snprintf(name, sizeof(name), "%s_teardown", m_name);
+    probe_t teardown(name);
+    delete words;
+    if(m_release) { m_release(resource); }
+    teardown.report();
+}
+
+static void release_arena(memory_resource_t *m_resource) { static_cast<arena_t*>(m_resource)->release(); }
+static void release_pool(memory_resource_t *m_resource) { static_cast<pool_t*>(m_resource)->release(); }
+
+static void bench_alloc(void) {
+    arena_t arena;
+    pool_t pool;
+    alloc_words("malloc", malloc_allocator_t(), 0);
+    alloc_words("arena", resource_allocator_t(&arena), release_arena);
+    alloc_words("pool", resource_allocator_t(&pool), release_pool);
+}
+
+// Same choice as doomed() for a string_view
+static bool doomed_view(const std::string_view &m_word) {
+    unsigned hash = 0;
+    for(size_t i = 0; i < m_word.size(); i++) { hash = (hash ^ (unsigned char)m_word[i]) * 16777619u; }
+    return (hash >> 16) & 1;
+}
+
+// Load, sort and filter 2^20 shuffled strings as vector_t<string_t> and as string_column_t
+static void bench_column(void) {
+    vector_t<string_t> shuffled;
+    make_words(shuffled, 1 << 20);
+    shuffle(shuffled.begin(), shuffled.end(), mt19937(1));
+    vector_t<string_t> words;
+    string_column_t column;
+    {
+        probe_t probe("vector_load");
+        for(size_t i = 0; i < shuffled.size(); i++) { words.push_back(shuffled[i]); }
+        probe.report();
+    }
+    {
+        probe_t probe("column_load");
+        for(size_t i = 0; i < shuffled.size(); i++) { column.push_back(&shuffled[i][0]); }
+        probe.report();
+        cout << "  vector: " << words.capacity() * sizeof(string_t) << " bytes of objects plus heap buffers, column: "
+             << column.capacity() * sizeof(string_column_t::span_t) + column.blob_size() << " bytes" << endl;
+    }
+    {
+        probe_t probe("vector_sort");
+        sort(words.begin(), words.end());
+        probe.report();
+    }
+    {
+        probe_t probe("column_sort");
+        column.sort();
+        probe.report();
+    }
+    {
+        probe_t probe("column_compact");
+        column.compact();
+        probe.report();
+    }
+    {
+        probe_t probe("vector_erase_if");
+        words.erase_if(doomed);
+        probe.report();
+    }
+    {
+        probe_t probe("column_erase_if");
+        column.erase_if(doomed_view);
+        probe.report();
+    }
+}
+
+// Split a generated file of 2^23 words, every fourth one longer than
+// WORD_SIZE, with getline() into strings and with word_file_t into views
+static void bench_load(void) {
+    const size_t count = 1 << 23;
+    char name[] = "/tmp/bench_load_XXXXXX", word[64];
+    int fd = mkstemp(name);
+    if(fd < 0) { cerr << "Error: failed to create " << name << endl; return; }
+    FILE *file = fdopen(fd, "w");
+    for(size_t i = 0; i < count; i++) { fprintf(file, i % 4 ? "w%zu\n" : "long word number %zu\n", i); }
+    fclose(file);
+    {
+        vector_t<string_t> words;
+        ifstream input_file(name);
+        probe_t probe("getline_load");
+        while(input_file.getline(word, sizeof(word))) { words.emplace_back(word); }
+        probe.report();
+    }
+    const unsigned threads[] = { 1, max(1u, thread::hardware_concurrency()) };
+    for(size_t t = 0; t < 2; t++) {
+        char probe_name[64];
+        snprintf(probe_name, sizeof(probe_name), "mmap_load_%u_threads", threads[t]);
+        word_file_t input_file;
+        vector_t<std::string_view> lines;
+        probe_t probe(probe_name);
+        input_file.open(name);
+        input_file.lines(lines, threads[t]);
+        probe.report();
+        cout << "  " << lines.size() << " words in " << input_file.size() << " bytes" << endl;
+    }
+    unlink(name);
+}
+
+// Sort 10M shuffled strings by strcmp() and by the cached key
+static void bench_sort(void) {
+    vector_t<string_t> shuffled;
+    make_words(shuffled, 10000000);
+    shuffle(shuffled.begin(), shuffled.end(), mt19937(1));
+    {
+        vector_t<string_t> words = shuffled;
+        probe_t probe("sort_strcmp");
+        sort(words.begin(), words.end(), [](const string_t &m_lhs, const string_t &m_rhs) {
+            return strcmp(&m_lhs[0], &m_rhs[0]) < 0; });
+        probe.report();
+    }
+    {
+        vector_t<string_t> words = shuffled;
+        probe_t probe("sort_key");
+        sort(words.begin(), words.end());
+        probe.report();
+    }
+}
+
+// Count word frequencies in a generated corpus of 2^23 words over a
+// vocabulary of 2^17, drawn log-uniformly so that a few words dominate.
+// The hash map looks up the mapped views directly, and the flat map
+// needs a string_t per word.
+static void bench_frequency(void) {
+    const size_t count = 1 << 23, vocabulary = 1 << 17;
+    char name[] = "/tmp/bench_frequency_XXXXXX";
+    int fd = mkstemp(name);
+    if(fd < 0) { cerr << "Error: failed to create " << name << endl; return; }
+    FILE *file = fdopen(fd, "w");
+    mt19937 random(1);
+    uniform_real_distribution<double> exponent(0, log((double)vocabulary));
+    for(size_t i = 0; i < count; i++) {
+        const size_t word = (size_t)exp(exponent(random)) - 1;
+        fprintf(file, word % 4 ? "w%zu\n" : "long word number %zu\n", word);
+    }
+    fclose(file);
+    word_file_t input_file;
+    vector_t<std::string_view> lines;
+    input_file.open(name);
+    input_file.lines(lines);
+    {
+        hash_map_t<string_t, size_t> counts;
+        probe_t probe("frequency_hash");
+        for(size_t i = 0; i < lines.size(); i++) {
+            hash_map_t<string_t, size_t>::iterator it = counts.find(lines[i]);
+            if(it != counts.end()) { it->second++; }
+            else { counts.insert(std::pair<string_t, size_t>(string_t(lines[i]), 1)); }
+        }
+        probe.report();
+        cout << "  " << counts.size() << " distinct words, \"w1\" " << counts.find("w1")->second << " times" << endl;
+    }
+    {
+        flat_map_t<string_t, size_t> counts;
+        probe_t probe("frequency_flat");
+        for(size_t i = 0; i < lines.size(); i++) { counts[string_t(lines[i])]++; }
+        probe.report();
+        cout << "  " << counts.size() << " distinct words" << endl;
+    }
+    unlink(name);
+}
+
+// Copy a hash map after random inserts and erases have left deleted
+// slots, and check that the copies find every key the original finds
+static void bench_hash_copy(void) {
+    const size_t rounds = 64, operations = 3000, keys = 1000;
+    mt19937 random(1);
+    size_t missing = 0, checked = 0;
+    probe_t probe("hash_copy");
+    for(size_t r = 0; r < rounds; r++) {
+        hash_map_t<string_t, int> map;
+        char word[32];
+        for(size_t i = 0; i < operations; i++) {
+            snprintf(word, sizeof(word), "key %u", (unsigned)(random() % keys));
+            if(random() % 2) { map[string_t(word)] = i; }
+            else { map.erase(word); }
+        }
+        hash_map_t<string_t, int> copy(map), assigned;
+        assigned = map;
+        for(size_t k = 0; k < keys; k++) {
+            snprintf(word, sizeof(word), "key %u", (unsigned)k);
+            if(!map.contains(word)) { continue; }
+            missing += !copy.contains(word) + !assigned.contains(word);
+            checked += 2;
+        }
+    }
+    probe.report(rounds);
+    cout << "  " << missing << " of " << checked << " keys missing from copies" << endl;
+}
+
+// Registered benchmarks
+struct bench_t {
+    const char *name;
+    void (*run)(void);
+};
+static const bench_t benches[] = {
+    { "workflow", bench_workflow },
+    { "relocate", bench_relocate },
+    { "shift",    bench_shift    },
+    { "erase_if", bench_erase_if },
+    { "erase_loop", bench_erase_loop },
+    { "sorted_insert", bench_sorted_insert },
+    { "flat_build", bench_flat_build },
+    { "flat_lookup", bench_flat_lookup },
+    { "alloc",    bench_alloc    },
+    { "column",   bench_column   },
+    { "load",     bench_load     },
+    { "sort",     bench_sort     },
+    { "frequency", bench_frequency },
+    { "hash_copy", bench_hash_copy },
+};
+
+int main(int argc, char **argv) {
+    load(argc > 1 ? argv[1] : "input");
+    const size_t num_benches = sizeof(benches) / sizeof(bench_t);
+    for(size_t b = 0; b < num_benches; b++) {
+        bool selected = argc <= 2;
+        for(int i = 2; i < argc; i++) { selected |= !strcmp(argv[i], benches[b].name); }
+        if(selected) { benches[b].run(); }
+    }
+    free(lines);
+    return 0;
+}
@@ -0,0 +1,112 @@
+#ifndef __FLAT_H__
+#define __FLAT_H__
+
+#include <functional> // std::less
+#include <utility>    // std::pair
+#include "vector.h"
+
+// Lookup layouts of flat containers
+enum flat_layout { flat_sorted = 0,     // Binary search over the sorted elements
+                   flat_eytzinger };    // Branch-free search over a BFS-ordered copy of the keys
+
+// Sorted unique elements in a vector_t, shared by flat_set_t and flat_map_t.
+// 'KeyOf::get(value)' returns the key of an element.
+template <typename Key, typename Value, typename KeyOf, typename Compare>
+class flat_base_t {
+public:
+    typedef typename vector_t<Value>::const_iterator const_iterator;
+
+    flat_base_t(const Compare &m_comp = Compare());
+
+    // Get the number of elements.
+    size_t size(void) const { return items.size(); }
+    // Remove all elements.
+    void clear(void);
+    // Get iterators over the elements in ascending key order.
+    const_iterator begin(void) const { return items.begin(); }
+    const_iterator end(void) const { return items.end(); }
+
+    // Get an iterator to the first element whose key is not less than the given key.
+    const_iterator lower_bound(const Key &m_key) const { return begin() + lower_index(m_key); }
+    // Get an iterator to the element with the given key, or end().
+    const_iterator find(const Key &m_key) const { return begin() + find_index(m_key); }
+    // Check if an element with the given key exists.
+    bool contains(const Key &m_key) const;
+
+    // Add an element unless its key exists, and return its position and whether it was added.
+    std::pair<const_iterator, bool> insert(const Value &m_value);
+    // Erase the element with the given key, and return the number of erased elements.
+    size_t erase(const Key &m_key);
+    // Append [m_first, m_last), then sort and drop duplicate keys in O(n log n).
+    // The first element of each key is kept, and existing elements come first.
+    template <typename InputIt>
+    void build(InputIt m_first, InputIt m_last);
+    // Sort the batch [m_first, m_last), and merge it with the elements in one pass.
+    // Keys that already exist are not replaced.
+    template <typename InputIt>
+    void insert_many(InputIt m_first, InputIt m_last);
+
+    // Get or change the lookup layout.
+    flat_layout layout(void) const { return kind; }
+    void set_layout(const flat_layout m_kind);
+
+protected:
+    // Eytzinger node (1-based) of the first key not less than the given key, or 0
+    size_t lower_node(const Key &m_key) const;
+    // Index of the first element whose key is not less than the given key
+    size_t lower_index(const Key &m_key) const;
+    // Index of the element with the given key, or size()
+    size_t find_index(const Key &m_key) const;
+    // Sort the elements and drop duplicate keys.
+    void sort_unique(void);
+    // Rebuild the Eytzinger copy of the keys after a change.
+    void update(void);
+    // Fill 'slot' with the in-order element indices of the subtree at 'm_k'.
+    size_t fill(size_t m_index, const size_t m_k);
+
+    vector_t<Value> items;      // Elements in ascending key order
+    vector_t<Key> tree;         // Eytzinger layout: the keys of a complete binary search tree in BFS order
+    vector_t<size_t> slot;      // Eytzinger layout: index in 'items' of every node of 'tree'
+    flat_layout kind;           // Lookup layout
+    Compare comp;               // Key ordering
+};
+
+// Key of a set element
+template <typename T>
+struct flat_set_key_t {
+    static const T& get(const T &m_value) { return m_value; }
+};
+
+// Key of a map element
+template <typename K, typename V>
+struct flat_map_key_t {
+    static const K& get(const std::pair<K, V> &m_value) { return m_value.first; }
+};
+
+// Sorted set of unique elements
+template <typename T, typename Compare = std::less<T> >
+class flat_set_t : public flat_base_t<T, T, flat_set_key_t<T>, Compare> {
+public:
+    flat_set_t(const Compare &m_comp = Compare()) :
+        flat_base_t<T, T, flat_set_key_t<T>, Compare>(m_comp) { /* Nothing to do */ }
+};
+
+// Sorted map of unique keys. Values may be changed in place, but keys must not.
+template <typename K, typename V, typename Compare = std::less<K> >
+class flat_map_t : public flat_base_t<K, std::pair<K, V>, flat_map_key_t<K, V>, Compare> {
+public:
+    typedef typename vector_t<std::pair<K, V> >::iterator iterator;
+
+    flat_map_t(const Compare &m_comp = Compare()) :
+        flat_base_t<K, std::pair<K, V>, flat_map_key_t<K, V>, Compare>(m_comp) { /* Nothing to do */ }
+
+    using flat_base_t<K, std::pair<K, V>, flat_map_key_t<K, V>, Compare>::find;
+    // Get an iterator to the element with the given key, or end().
+    iterator find(const K &m_key) { return this->items.begin() + this->find_index(m_key); }
+    // Get the value of the given key, adding a value-initialized one if the key does not exist.
+    V& operator[](const K &m_key);
+};
+
+#include "flat.hpp"
+
+#endif
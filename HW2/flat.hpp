@@ -0,0 +1,182 @@
+/* flat.hpp */
+#ifndef __FLAT_HPP__
+#define __FLAT_HPP__
+
+#include <algorithm> // std::lower_bound, std::stable_sort
+#include <cstdint>   // uintptr_t
+
+// Constructor
+template <typename Key, typename Value, typename KeyOf, typename Compare>
+flat_base_t<Key, Value, KeyOf, Compare>::flat_base_t(const Compare &m_comp) :
+    kind(flat_sorted),
+    comp(m_comp) {
+    // Nothing to do
+}
+
+// Remove all elements.
+template <typename Key, typename Value, typename KeyOf, typename Compare>
+void flat_base_t<Key, Value, KeyOf, Compare>::clear(void) {
+    items.clear();
+    update();
+}
+
+// Change the lookup layout.
+template <typename Key, typename Value, typename KeyOf, typename Compare>
+void flat_base_t<Key, Value, KeyOf, Compare>::set_layout(const flat_layout m_kind) {
+    kind = m_kind;
+    update();
+}
+
+// Eytzinger node (1-based) of the first key not less than the given key, or 0
+template <typename Key, typename Value, typename KeyOf, typename Compare>
+size_t flat_base_t<Key, Value, KeyOf, Compare>::lower_node(const Key &m_key) const {
+    // Node k has children 2k and 2k+1. The search goes right while the
+    // node is less than the key, without a branch on the result, and the
+    // answer is the last node where it went left: drop the trailing right
+    // turns and one more. The 2^depth descendants 'depth' levels below k
+    // are contiguous, so fetching them ahead hides most cache misses.
+    const size_t n = tree.size(), depth = sizeof(Key) <= 8 ? 4 : sizeof(Key) <= 32 ? 2 : 1;
+    const uintptr_t base = n ? (uintptr_t)&tree[0] : 0;
+    size_t k = 1;
+    while(k <= n) {
+        __builtin_prefetch((const void*)(base + ((k << depth) - 1) * sizeof(Key)));
+        k = 2 * k + comp(tree[k-1], m_key);
+    }
+    return k >> __builtin_ffsll(~k);
+}
+
+// Index of the first element whose key is not less than the given key
+template <typename Key, typename Value, typename KeyOf, typename Compare>
+size_t flat_base_t<Key, Value, KeyOf, Compare>::lower_index(const Key &m_key) const {
+    if(kind == flat_eytzinger) {
+        size_t k = lower_node(m_key);
+        return k ? slot[k-1] : size();
+    }
+    return std::lower_bound(items.begin(), items.end(), m_key,
+                            [this](const Value &m_value, const Key &m_key) {
+                                return comp(KeyOf::get(m_value), m_key); }) - items.begin();
+}
+
+// Index of the element with the given key, or size()
+template <typename Key, typename Value, typename KeyOf, typename Compare>
+size_t flat_base_t<Key, Value, KeyOf, Compare>::find_index(const Key &m_key) const {
+    size_t index = lower_index(m_key);
+    return (index < size()) && !comp(m_key, KeyOf::get(items[index])) ? index : size();
+}
+
+// Check if an element with the given key exists.
+template <typename Key, typename Value, typename KeyOf, typename Compare>
+bool flat_base_t<Key, Value, KeyOf, Compare>::contains(const Key &m_key) const {
+    if(kind == flat_eytzinger) {
+        // The tree alone answers, without touching 'slot' or the elements.
+        size_t k = lower_node(m_key);
+        return k && !comp(m_key, tree[k-1]);
+    }
+    return find_index(m_key) != size();
+}
+
+// Add an element unless its key exists.
+template <typename Key, typename Value, typename KeyOf, typename Compare>
+std::pair<typename flat_base_t<Key, Value, KeyOf, Compare>::const_iterator, bool>
+flat_base_t<Key, Value, KeyOf, Compare>::insert(const Value &m_value) {
+    const Key &key = KeyOf::get(m_value);
+    size_t index = lower_index(key);
+    if((index < size()) && !comp(key, KeyOf::get(items[index]))) {
+        return std::make_pair(begin() + index, false);
+    }
+    items.insert(items.begin() + index, m_value);
+    update();
+    return std::make_pair(begin() + index, true);
+}
+
+// Erase the element with the given key.
+template <typename Key, typename Value, typename KeyOf, typename Compare>
+size_t flat_base_t<Key, Value, KeyOf, Compare>::erase(const Key &m_key) {
+    size_t index = find_index(m_key);
+    if(index == size()) { return 0; }
+    items.erase(items.begin() + index);
+    update();
+    return 1;
+}
+
+// Append [m_first, m_last), then sort and drop duplicate keys.
+template <typename Key, typename Value, typename KeyOf, typename Compare>
+template <typename InputIt>
+void flat_base_t<Key, Value, KeyOf, Compare>::build(InputIt m_first, InputIt m_last) {
+    for(; m_first != m_last; ++m_first) { items.push_back(*m_first); }
+    sort_unique();
+    update();
+}
+
+// Sort the batch [m_first, m_last), and merge it with the elements in one pass.
+template <typename Key, typename Value, typename KeyOf, typename Compare>
+template <typename InputIt>
+void flat_base_t<Key, Value, KeyOf, Compare>::insert_many(InputIt m_first, InputIt m_last) {
+    flat_base_t<Key, Value, KeyOf, Compare> batch(comp);
+    batch.build(m_first, m_last);
+
+    vector_t<Value> merged;
+    merged.reserve(items.size() + batch.size());
+    size_t i = 0, j = 0;
+    while((i < items.size()) && (j < batch.size())) {
+        const Key &old_key = KeyOf::get(items[i]), &new_key = KeyOf::get(batch.items[j]);
+        if(comp(new_key, old_key)) { merged.push_back(std::move(batch.items[j++])); }
+        else {
+            if(!comp(old_key, new_key)) { j++; }     // Existing key wins
+            merged.push_back(std::move(items[i++]));
+        }
+    }
+    for(; i < items.size(); i++) { merged.push_back(std::move(items[i])); }
+    for(; j < batch.size(); j++) { merged.push_back(std::move(batch.items[j])); }
+    items = std::move(merged);
+    update();
+}
+
+// Sort the elements and drop duplicate keys, keeping the first of each.
+template <typename Key, typename Value, typename KeyOf, typename Compare>
+void flat_base_t<Key, Value, KeyOf, Compare>::sort_unique(void) {
+    std::stable_sort(items.begin(), items.end(), [this](const Value &m_a, const Value &m_b) {
+        return comp(KeyOf::get(m_a), KeyOf::get(m_b)); });
+    items.unique([this](const Value &m_a, const Value &m_b) {
+        return !comp(KeyOf::get(m_a), KeyOf::get(m_b)); });
+}
+
+// Rebuild the Eytzinger copy of the keys. Every change pays O(n) for it,
+// so load in bulk before switching a read-mostly container to it.
+template <typename Key, typename Value, typename KeyOf, typename Compare>
+void flat_base_t<Key, Value, KeyOf, Compare>::update(void) {
+    tree.clear();
+    slot.clear();
+    if(kind != flat_eytzinger) { return; }
+
+    const size_t n = size();
+    tree.reserve(n);
+    slot.reserve(n);
+    for(size_t k = 0; k < n; k++) { slot.push_back(0); }
+    fill(0, 1);
+    for(size_t k = 0; k < n; k++) { tree.push_back(KeyOf::get(items[slot[k]])); }
+}
+
+// Fill 'slot' with the in-order element indices of the subtree at node 'm_k'.
+template <typename Key, typename Value, typename KeyOf, typename Compare>
+size_t flat_base_t<Key, Value, KeyOf, Compare>::fill(size_t m_index, const size_t m_k) {
+    if(m_k <= size()) {
+        m_index = fill(m_index, 2 * m_k);
+        slot[m_k-1] = m_index++;
+        m_index = fill(m_index, 2 * m_k + 1);
+    }
+    return m_index;
+}
+
+// Get the value of the given key, adding a value-initialized one if the key does not exist.
+template <typename K, typename V, typename Compare>
+V& flat_map_t<K, V, Compare>::operator[](const K &m_key) {
+    size_t index = this->lower_index(m_key);
+    if((index == this->size()) || this->comp(m_key, this->items[index].first)) {
+        this->items.insert(this->items.begin() + index, std::pair<K, V>(m_key, V()));
+        this->update();
+    }
+    return this->items[index].second;
+}
+
+#endif
@@ -0,0 +1,218 @@
+#ifndef __HASH_H__
+#define __HASH_H__
+
+#include <cstdint>     // uint64_t
+#include <cstring>     // strlen
+#include <functional>  // std::hash
+#include <iterator>    // forward_iterator_tag
+#include <new>         // bad_alloc
+#include <string_view>
+#include <type_traits> // remove_const
+#include <utility>     // std::pair
+#include "relocate.h"
+#include "string.h"
+
+// Hash of a key. The default uses std::hash, and string_t uses its cached
+// hash. Lookups with other key types need an overload for them.
+template <typename T>
+struct hash_t {
+    size_t operator()(const T &m_key) const { return std::hash<T>()(m_key); }
+};
+
+// string_t is also looked up by const char* and std::string_view, hashed
+// the same way without making a string_t.
+template <>
+struct hash_t<string_t> {
+    size_t operator()(const string_t &m_key) const { return m_key.hash(); }
+    size_t operator()(const char *m_key) const { return (uint32_t)string_t::hash_chars(m_key, strlen(m_key)); }
+    size_t operator()(const std::string_view &m_key) const { return (uint32_t)string_t::hash_chars(m_key.data(), m_key.size()); }
+};
+
+// Equality of a stored key and a lookup key
+template <typename T>
+struct hash_equal_t {
+    template <typename U>
+    bool operator()(const T &m_lhs, const U &m_rhs) const { return m_lhs == m_rhs; }
+};
+
+template <>
+struct hash_equal_t<string_t> {
+    bool operator()(const string_t &m_lhs, const string_t &m_rhs) const { return m_lhs == m_rhs; }
+    bool operator()(const string_t &m_lhs, const char *m_rhs) const { return (*this)(m_lhs, std::string_view(m_rhs)); }
+    bool operator()(const string_t &m_lhs, const std::string_view &m_rhs) const {
+        return (m_lhs.size() == m_rhs.size()) && !memcmp(m_lhs.c_str(), m_rhs.data(), m_rhs.size());
+    }
+};
+
+// Forward iterator over the occupied slots of a hash table
+template <typename Value>
+class hash_iterator_t {
+template <typename K, typename V, typename KO, typename H, typename E> friend class hash_base_t;
+template <typename V> friend class hash_iterator_t;
+public:
+    typedef std::forward_iterator_tag               iterator_category;
+    typedef typename std::remove_const<Value>::type value_type;
+    typedef std::ptrdiff_t                          difference_type;
+    typedef Value*                                  pointer;
+    typedef Value&                                  reference;
+
+    hash_iterator_t(void) : ctrl(0), slot(0), last(0) { /* Nothing to do */ }
+    // Conversion from iterator to const_iterator
+    template <typename U, typename = typename std::enable_if<std::is_convertible<U*, Value*>::value>::type>
+    hash_iterator_t(const hash_iterator_t<U> &m_it) : ctrl(m_it.ctrl), slot(m_it.slot), last(m_it.last) { }
+
+    Value& operator*(void) const { return *slot; }
+    Value* operator->(void) const { return slot; }
+    hash_iterator_t& operator++(void) { ++ctrl; ++slot; skip(); return *this; }
+    hash_iterator_t operator++(int) { hash_iterator_t it = *this; ++*this; return it; }
+    // Comparison of iterators and const_iterators
+    template <typename U>
+    bool operator==(const hash_iterator_t<U> &m_it) const { return ctrl == m_it.ctrl; }
+    template <typename U>
+    bool operator!=(const hash_iterator_t<U> &m_it) const { return ctrl != m_it.ctrl; }
+
+private:
+    hash_iterator_t(const int8_t *m_ctrl, Value *m_slot, const int8_t *m_last) :
+        ctrl(m_ctrl), slot(m_slot), last(m_last) { skip(); }
+    // Move forward to an occupied slot or the end.
+    void skip(void) { while((ctrl < last) && (*ctrl < 0)) { ++ctrl; ++slot; } }
+
+    const int8_t *ctrl;     // Control byte of the slot
+    Value *slot;            // Element of the slot
+    const int8_t *last;     // End of the control bytes
+};
+
+// Open-addressing hash table, shared by hash_set_t and hash_map_t
+// Slots are split into groups of 16, and every slot has a control byte:
+// empty, deleted, or the low 7 bits of the element's hash when occupied.
+// A lookup picks a group from the other bits of the hash, compares the
+// 16 control bytes at once with SSE2, and checks the keys only where the
+// 7 bits match. It moves on to further groups (triangular probing) until
+// one has an empty slot. The table grows at 7/8 occupancy, and relocates
+// elements with the relocation trait. 'KeyOf::get(value)' returns the
+// key of an element, and lookups take any key type that 'Hash' and
+// 'Equal' accept.
+template <typename Key, typename Value, typename KeyOf, typename Hash, typename Equal>
+class hash_base_t {
+public:
+    typedef hash_iterator_t<Value> iterator;
+    typedef hash_iterator_t<const Value> const_iterator;
+
+    hash_base_t(const Hash &m_hash = Hash(), const Equal &m_equal = Equal());
+    hash_base_t(const hash_base_t &m_table);
+    hash_base_t(hash_base_t &&m_table) noexcept;
+    ~hash_base_t(void);
+    hash_base_t& operator=(const hash_base_t &m_table);
+    hash_base_t& operator=(hash_base_t &&m_table) noexcept;
+
+    // Get the number of elements.
+    size_t size(void) const { return num_elements; }
+    // Get the number of slots.
+    size_t capacity(void) const { return num_slots; }
+    // Remove all elements, keeping the slots.
+    void clear(void);
+    // Make room for 'm_size' elements without growing.
+    void reserve(const size_t m_size);
+    // Get iterators over the elements in no particular order.
+    const_iterator begin(void) const { return const_iterator(ctrl, slots, ctrl + num_slots); }
+    const_iterator end(void) const { return const_iterator(ctrl + num_slots, slots + num_slots, ctrl + num_slots); }
+
+    // Get an iterator to the element with the given key, or end().
+    template <typename K>
+    const_iterator find(const K &m_key) const { return at(find_index(m_key)); }
+    // Check if an element with the given key exists.
+    template <typename K>
+    bool contains(const K &m_key) const { return find_index(m_key) != num_slots; }
+
+    // Add an element unless its key exists, and return its position and whether it was added.
+    std::pair<const_iterator, bool> insert(const Value &m_value) { return insert_value(Value(m_value)); }
+    std::pair<const_iterator, bool> insert(Value &&m_value) { return insert_value(std::move(m_value)); }
+    // Add [m_first, m_last) after reserving room for all of them.
+    template <typename ForwardIt>
+    void insert_many(ForwardIt m_first, ForwardIt m_last);
+    // Erase the element with the given key, and return the number of erased elements.
+    template <typename K>
+    size_t erase(const K &m_key);
+
+protected:
+    static const size_t GROUP_SIZE = 16;
+    static const int8_t EMPTY = -128;   // Never used, ends a probe
+    static const int8_t DELETED = -2;   // Erased, does not end a probe
+
+    // Hash of a key, spread over all 64 bits
+    template <typename K>
+    uint64_t hash_of(const K &m_key) const;
+    // Bit mask of the slots in a group whose control byte is 'm_byte'
+    static unsigned match(const int8_t *m_group, const int8_t m_byte);
+    static unsigned match_empty(const int8_t *m_group) { return match(m_group, EMPTY); }
+    // Index of the slot with the given key, or capacity()
+    template <typename K>
+    size_t find_index(const K &m_key) const;
+    // Index of the first empty or deleted slot on the probe sequence of a hash
+    size_t free_index(const uint64_t m_hash) const;
+    // Add an element unless its key exists.
+    std::pair<const_iterator, bool> insert_value(Value &&m_value);
+    // Move all elements to a table of 'm_slots' slots.
+    void rehash(const size_t m_slots);
+    // Allocate empty slots, or none.
+    void allocate(const size_t m_slots);
+    // Destroy the elements and free the slots.
+    void release(void);
+    // Iterator at a slot index
+    const_iterator at(const size_t m_index) const { return const_iterator(ctrl + m_index, slots + m_index, ctrl + num_slots); }
+    iterator at(const size_t m_index) { return iterator(ctrl + m_index, slots + m_index, ctrl + num_slots); }
+    // Slot index of an iterator
+    size_t index_of(const const_iterator &m_it) const { return m_it.ctrl - ctrl; }
+    // Number of elements the slots hold before growing
+    static size_t max_load(const size_t m_slots) { return m_slots - m_slots / 8; }
+
+    int8_t *ctrl;           // Control bytes of the slots
+    Value *slots;           // Elements, constructed only in occupied slots
+    size_t num_slots;       // Number of slots, 0 or a power of two not less than GROUP_SIZE
+    size_t num_elements;    // Number of occupied slots
+    size_t growth_left;     // Empty slots to fill before growing
+    Hash hasher;            // Hash of keys
+    Equal equal;            // Equality of keys
+};
+
+// Key of a set element
+template <typename T>
+struct hash_set_key_t {
+    static const T& get(const T &m_value) { return m_value; }
+};
+
+// Key of a map element
+template <typename K, typename V>
+struct hash_map_key_t {
+    static const K& get(const std::pair<K, V> &m_value) { return m_value.first; }
+};
+
+// Unordered set of unique elements
+template <typename T, typename Hash = hash_t<T>, typename Equal = hash_equal_t<T> >
+class hash_set_t : public hash_base_t<T, T, hash_set_key_t<T>, Hash, Equal> {
+public:
+    hash_set_t(const Hash &m_hash = Hash(), const Equal &m_equal = Equal()) :
+        hash_base_t<T, T, hash_set_key_t<T>, Hash, Equal>(m_hash, m_equal) { /* Nothing to do */ }
+};
+
+// Unordered map of unique keys. Values may be changed in place, but keys must not.
+template <typename K, typename V, typename Hash = hash_t<K>, typename Equal = hash_equal_t<K> >
+class hash_map_t : public hash_base_t<K, std::pair<K, V>, hash_map_key_t<K, V>, Hash, Equal> {
+public:
+    typedef hash_base_t<K, std::pair<K, V>, hash_map_key_t<K, V>, Hash, Equal> base_t;
+    typedef typename base_t::iterator iterator;
+
+    hash_map_t(const Hash &m_hash = Hash(), const Equal &m_equal = Equal()) :
+        base_t(m_hash, m_equal) { /* Nothing to do */ }
+
+    using base_t::find;
+    // Get an iterator to the element with the given key, or end().
+    template <typename L>
+    iterator find(const L &m_key) { return this->at(this->find_index(m_key)); }
+    // Get the value of the given key, adding a value-initialized one if the key does not exist.
+    V& operator[](const K &m_key);
+};
+
+#include "hash.hpp"
+
+#endif
@@ -0,0 +1,264 @@
+/* hash.hpp */
+#ifndef __HASH_HPP__
+#define __HASH_HPP__
+
+#include <cstdlib>   // malloc, free
+#include <iterator>  // std::distance
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Constructor
+template <typename Key, typename Value, typename KeyOf, typename Hash, typename Equal>
+hash_base_t<Key, Value, KeyOf, Hash, Equal>::hash_base_t(const Hash &m_hash, const Equal &m_equal) :
+    ctrl(0),
+    slots(0),
+    num_slots(0),
+    num_elements(0),
+    growth_left(0),
+    hasher(m_hash),
+    equal(m_equal) {
+    // Nothing to do
+}
+
+// Copy constructor, keeping every element in the same slot. The control
+// bytes are copied verbatim, since a deleted slot must still let probes
+// pass on to the elements stored beyond it.
+template <typename Key, typename Value, typename KeyOf, typename Hash, typename Equal>
+hash_base_t<Key, Value, KeyOf, Hash, Equal>::hash_base_t(const hash_base_t &m_table) :
+    ctrl(0),
+    slots(0),
+    num_slots(0),
+    num_elements(0),
+    growth_left(0),
+    hasher(m_table.hasher),
+    equal(m_table.equal) {
+    allocate(m_table.num_slots);
+    for(size_t i = 0; i < num_slots; i++) {
+        if(m_table.ctrl[i] >= 0) {
+            new (&slots[i]) Value(m_table.slots[i]);
+            ctrl[i] = m_table.ctrl[i];
+            num_elements++;
+        }
+        else { ctrl[i] = m_table.ctrl[i]; }
+    }
+    growth_left = m_table.growth_left;
+}
+
+// Move constructor
+template <typename Key, typename Value, typename KeyOf, typename Hash, typename Equal>
+hash_base_t<Key, Value, KeyOf, Hash, Equal>::hash_base_t(hash_base_t &&m_table) noexcept :
+    ctrl(m_table.ctrl),
+    slots(m_table.slots),
+    num_slots(m_table.num_slots),
+    num_elements(m_table.num_elements),
+    growth_left(m_table.growth_left),
+    hasher(m_table.hasher),
+    equal(m_table.equal) {
+    m_table.ctrl = 0;
+    m_table.slots = 0;
+    m_table.num_slots = m_table.num_elements = m_table.growth_left = 0;
+}
+
+// Destructor
+template <typename Key, typename Value, typename KeyOf, typename Hash, typename Equal>
+hash_base_t<Key, Value, KeyOf, Hash, Equal>::~hash_base_t(void) {
+    release();
+}
+
+// Copy assignment
+template <typename Key, typename Value, typename KeyOf, typename Hash, typename Equal>
+hash_base_t<Key, Value, KeyOf, Hash, Equal>& hash_base_t<Key, Value, KeyOf, Hash, Equal>::operator=(const hash_base_t &m_table) {
+    if(&m_table != this) { *this = hash_base_t(m_table); }
+    return *this;
+}
+
+// Move assignment
+template <typename Key, typename Value, typename KeyOf, typename Hash, typename Equal>
+hash_base_t<Key, Value, KeyOf, Hash, Equal>& hash_base_t<Key, Value, KeyOf, Hash, Equal>::operator=(hash_base_t &&m_table) noexcept {
+    if(&m_table == this) { return *this; }
+    release();
+    ctrl = m_table.ctrl;
+    slots = m_table.slots;
+    num_slots = m_table.num_slots;
+    num_elements = m_table.num_elements;
+    growth_left = m_table.growth_left;
+    hasher = m_table.hasher;
+    equal = m_table.equal;
+    m_table.ctrl = 0;
+    m_table.slots = 0;
+    m_table.num_slots = m_table.num_elements = m_table.growth_left = 0;
+    return *this;
+}
+
+// Remove all elements, keeping the slots.
+template <typename Key, typename Value, typename KeyOf, typename Hash, typename Equal>
+void hash_base_t<Key, Value, KeyOf, Hash, Equal>::clear(void) {
+    for(size_t i = 0; i < num_slots; i++) {
+        if(ctrl[i] >= 0) { slots[i].~Value(); }
+        ctrl[i] = EMPTY;
+    }
+    num_elements = 0;
+    growth_left = max_load(num_slots);
+}
+
+// Make room for 'm_size' elements without growing.
+template <typename Key, typename Value, typename KeyOf, typename Hash, typename Equal>
+void hash_base_t<Key, Value, KeyOf, Hash, Equal>::reserve(const size_t m_size) {
+    size_t slots_needed = GROUP_SIZE;
+    while(max_load(slots_needed) < m_size) { slots_needed *= 2; }
+    if(slots_needed > num_slots) { rehash(slots_needed); }
+}
+
+// Add [m_first, m_last) after reserving room for all of them.
+template <typename Key, typename Value, typename KeyOf, typename Hash, typename Equal>
+template <typename ForwardIt>
+void hash_base_t<Key, Value, KeyOf, Hash, Equal>::insert_many(ForwardIt m_first, ForwardIt m_last) {
+    reserve(num_elements + std::distance(m_first, m_last));
+    for(; m_first != m_last; ++m_first) { insert(*m_first); }
+}
+
+// Erase the element with the given key. A slot becomes empty again if its
+// group has an empty slot, since no probe then passes the group.
+template <typename Key, typename Value, typename KeyOf, typename Hash, typename Equal>
+template <typename K>
+size_t hash_base_t<Key, Value, KeyOf, Hash, Equal>::erase(const K &m_key) {
+    const size_t index = find_index(m_key);
+    if(index == num_slots) { return 0; }
+    slots[index].~Value();
+    if(match_empty(ctrl + index / GROUP_SIZE * GROUP_SIZE)) { ctrl[index] = EMPTY; growth_left++; }
+    else { ctrl[index] = DELETED; }
+    num_elements--;
+    return 1;
+}
+
+// Hash of a key, spread over all 64 bits. The low 7 bits go to the
+// control byte, and the rest pick the group.
+template <typename Key, typename Value, typename KeyOf, typename Hash, typename Equal>
+template <typename K>
+uint64_t hash_base_t<Key, Value, KeyOf, Hash, Equal>::hash_of(const K &m_key) const {
+    return hash_mix(hasher(m_key), 0x9e3779b97f4a7c15ull);
+}
+
+// Bit mask of the slots in a group whose control byte is 'm_byte'
+template <typename Key, typename Value, typename KeyOf, typename Hash, typename Equal>
+unsigned hash_base_t<Key, Value, KeyOf, Hash, Equal>::match(const int8_t *m_group, const int8_t m_byte) {
+#ifdef __SSE2__
+    const __m128i group = _mm_loadu_si128((const __m128i*)m_group);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(m_byte)));
+#else
+    unsigned mask = 0;
+    for(size_t i = 0; i < GROUP_SIZE; i++) { mask |= (unsigned)(m_group[i] == m_byte) << i; }
+    return mask;
+#endif
+}
+
+// Index of the slot with the given key, or capacity()
+template <typename Key, typename Value, typename KeyOf, typename Hash, typename Equal>
+template <typename K>
+size_t hash_base_t<Key, Value, KeyOf, Hash, Equal>::find_index(const K &m_key) const {
+    if(!num_elements) { return num_slots; }
+    const uint64_t hash = hash_of(m_key);
+    const size_t mask = num_slots / GROUP_SIZE - 1;
+    size_t group = (hash >> 7) & mask;
+    for(size_t step = 1; ; step++) {
+        const size_t first = group * GROUP_SIZE;
+        for(unsigned hits = match(ctrl + first, hash & 0x7f); hits; hits &= hits - 1) {
+            const size_t index = first + __builtin_ctz(hits);
+            if(equal(KeyOf::get(slots[index]), m_key)) { return index; }
+        }
+        if(match_empty(ctrl + first)) { return num_slots; }
+        group = (group + step) & mask;
+    }
+}
+
+// Index of the first empty or deleted slot on the probe sequence of a hash
+template <typename Key, typename Value, typename KeyOf, typename Hash, typename Equal>
+size_t hash_base_t<Key, Value, KeyOf, Hash, Equal>::free_index(const uint64_t m_hash) const {
+    const size_t mask = num_slots / GROUP_SIZE - 1;
+    size_t group = (m_hash >> 7) & mask;
+    for(size_t step = 1; ; step++) {
+        const size_t first = group * GROUP_SIZE;
+        const unsigned free = match_empty(ctrl + first) | match(ctrl + first, DELETED);
+        if(free) { return first + __builtin_ctz(free); }
+        group = (group + step) & mask;
+    }
+}
+
+// Add an element unless its key exists. The table doubles when it runs
+// out of empty slots, or is rebuilt at the same size if deleted slots
+// make up most of the load.
+template <typename Key, typename Value, typename KeyOf, typename Hash, typename Equal>
+std::pair<typename hash_base_t<Key, Value, KeyOf, Hash, Equal>::const_iterator, bool>
+hash_base_t<Key, Value, KeyOf, Hash, Equal>::insert_value(Value &&m_value) {
+    const Key &key = KeyOf::get(m_value);
+    size_t index = find_index(key);
+    if(index != num_slots) { return std::make_pair(at(index), false); }
+    if(!growth_left) {
+        rehash(num_elements * 2 < max_load(num_slots) ? num_slots : num_slots ? 2 * num_slots : GROUP_SIZE);
+    }
+
+    const uint64_t hash = hash_of(key);
+    index = free_index(hash);
+    if(ctrl[index] == EMPTY) { growth_left--; }
+    new (&slots[index]) Value(std::move(m_value));
+    ctrl[index] = hash & 0x7f;
+    num_elements++;
+    return std::make_pair(at(index), true);
+}
+
+// Move all elements to a table of 'm_slots' slots.
+template <typename Key, typename Value, typename KeyOf, typename Hash, typename Equal>
+void hash_base_t<Key, Value, KeyOf, Hash, Equal>::rehash(const size_t m_slots) {
+    int8_t *old_ctrl = ctrl;
+    Value *old_slots = slots;
+    const size_t old_num_slots = num_slots;
+    ctrl = 0;
+    slots = 0;
+    allocate(m_slots);
+
+    for(size_t i = 0; i < old_num_slots; i++) {
+        if(old_ctrl[i] < 0) { continue; }
+        const uint64_t hash = hash_of(KeyOf::get(old_slots[i]));
+        const size_t index = free_index(hash);
+        relocate(&slots[index], &old_slots[i], 1);
+        ctrl[index] = hash & 0x7f;
+    }
+    growth_left = max_load(num_slots) - num_elements;
+    free(old_slots);
+}
+
+// Allocate empty slots, or none. The control bytes follow the elements
+// in the same block.
+template <typename Key, typename Value, typename KeyOf, typename Hash, typename Equal>
+void hash_base_t<Key, Value, KeyOf, Hash, Equal>::allocate(const size_t m_slots) {
+    num_slots = m_slots;
+    growth_left = max_load(m_slots);
+    if(!m_slots) { return; }
+    slots = (Value*)malloc((sizeof(Value) + 1) * m_slots);
+    if(!slots) { throw std::bad_alloc(); }
+    ctrl = (int8_t*)(slots + m_slots);
+    memset(ctrl, EMPTY, m_slots);
+}
+
+// Destroy the elements and free the slots.
+template <typename Key, typename Value, typename KeyOf, typename Hash, typename Equal>
+void hash_base_t<Key, Value, KeyOf, Hash, Equal>::release(void) {
+    for(size_t i = 0; i < num_slots; i++) {
+        if(ctrl[i] >= 0) { slots[i].~Value(); }
+    }
+    free(slots);
+    ctrl = 0;
+    slots = 0;
+    num_slots = num_elements = growth_left = 0;
+}
+
+// Get the value of the given key, adding a value-initialized one if the key does not exist.
+template <typename K, typename V, typename Hash, typename Equal>
+V& hash_map_t<K, V, Hash, Equal>::operator[](const K &m_key) {
+    size_t index = this->find_index(m_key);
+    if(index == this->num_slots) { index = this->index_of(this->insert_value(std::pair<K, V>(m_key, V())).first); }
+    return this->slots[index].second;
+}
+
+#endif
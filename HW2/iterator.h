@@ -1,35 +1,71 @@
 #ifndef __VECTOR_ITERATOR_H__
 #define __VECTOR_ITERATOR_H__
 
-template <typename T> class vector_t;
+#include <cstddef>     // ptrdiff_t
+#include <iterator>    // random_access_iterator_tag
+#include <type_traits> // remove_const
 
+template <typename T, typename Alloc> class vector_t;
+
+// Random-access iterator of vector_t<T>. iterator_t<const T> is the
+// const_iterator, and an iterator converts to it implicitly.
 template <typename T>
 class iterator_t {
-friend class vector_t<T>; 
+template <typename U, typename Alloc> friend class vector_t;
+template <typename U> friend class iterator_t;
 public:
+    // Member types for std::iterator_traits
+    typedef std::random_access_iterator_tag         iterator_category;
+    typedef typename std::remove_const<T>::type     value_type;
+    typedef std::ptrdiff_t                          difference_type;
+    typedef T*                                      pointer;
+    typedef T&                                      reference;
+
     iterator_t(void) : ptr(0) { /* Nothing to do */ }
     iterator_t(T *m_ptr) : ptr(m_ptr) { /* Nothing to do */ }
     iterator_t(const iterator_t<T> &m_it) : ptr(m_it.ptr) { /* Nothing to do */ }
+    // Conversion from iterator to const_iterator
+    template <typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+    iterator_t(const iterator_t<U> &m_it) : ptr(m_it.ptr) { /* Nothing to do */ }
     ~iterator_t(void) { /* Nothing to do */ }
 
+    iterator_t<T>& operator=(const iterator_t<T> &m_it) { ptr = m_it.ptr; return *this; }
+
     // Deference operator
     T& operator*(void) const { return *ptr; }
+    // Member access operator
+    T* operator->(void) const { return ptr; }
+    // Subscript operator
+    T& operator[](const difference_type m_n) const { return ptr[m_n]; }
     // Prefix increment operator
-    iterator_t<T> operator++(void) { ++ptr; return *this; }
+    iterator_t<T>& operator++(void) { ++ptr; return *this; }
     // Postfix increment operator
     iterator_t<T> operator++(int) { return iterator_t<T>(ptr++); }
     // Prefix decrement operator
-    iterator_t<T> operator--(void) { --ptr; return *this; }
+    iterator_t<T>& operator--(void) { --ptr; return *this; }
     // Postfix decrement operator
     iterator_t<T> operator--(int) { return iterator_t<T>(ptr--); }
-    // Equal operator
-    bool operator==(const iterator_t<T> &m_it) const { return ptr == m_it.ptr; }
-    // Not-equal operator
-    bool operator!=(const iterator_t<T> &m_it) const { return ptr != m_it.ptr; }
+    // Compound assignment operators
+    iterator_t<T>& operator+=(const difference_type m_n) { ptr += m_n; return *this; }
+    iterator_t<T>& operator-=(const difference_type m_n) { ptr -= m_n; return *this; }
+
+    // Arithmetic operators
+    friend iterator_t<T> operator+(const iterator_t<T> &m_it, const difference_type m_n) { return iterator_t<T>(m_it.ptr + m_n); }
+    friend iterator_t<T> operator+(const difference_type m_n, const iterator_t<T> &m_it) { return iterator_t<T>(m_it.ptr + m_n); }
+    friend iterator_t<T> operator-(const iterator_t<T> &m_it, const difference_type m_n) { return iterator_t<T>(m_it.ptr - m_n); }
+    // Distance between two iterators
+    friend difference_type operator-(const iterator_t<T> &m_lhs, const iterator_t<T> &m_rhs) { return m_lhs.ptr - m_rhs.ptr; }
+
+    // Comparison operators
+    friend bool operator==(const iterator_t<T> &m_lhs, const iterator_t<T> &m_rhs) { return m_lhs.ptr == m_rhs.ptr; }
+    friend bool operator!=(const iterator_t<T> &m_lhs, const iterator_t<T> &m_rhs) { return m_lhs.ptr != m_rhs.ptr; }
+    friend bool operator< (const iterator_t<T> &m_lhs, const iterator_t<T> &m_rhs) { return m_lhs.ptr <  m_rhs.ptr; }
+    friend bool operator> (const iterator_t<T> &m_lhs, const iterator_t<T> &m_rhs) { return m_lhs.ptr >  m_rhs.ptr; }
+    friend bool operator<=(const iterator_t<T> &m_lhs, const iterator_t<T> &m_rhs) { return m_lhs.ptr <= m_rhs.ptr; }
+    friend bool operator>=(const iterator_t<T> &m_lhs, const iterator_t<T> &m_rhs) { return m_lhs.ptr >= m_rhs.ptr; }
 
 private:
     T *ptr;
 };
 
 #endif
-
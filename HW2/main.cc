@@ -1,70 +1,85 @@
+#include <algorithm>
+#include <cstring>
 #include <iostream>
-#include <fstream>
+#include <string_view>
 #include "string.h"
+#include "string_column.h"
 #include "vector.h"
-
-#define WORD_SIZE 16
+#include "word_file.h"
 
 using namespace std;
 
-// Print the information of vector_t<string_t>.
-void print(const vector_t<string_t> &m_vector) {
-    cout << "capacity()="   << m_vector.capacity()  << endl
-         << "size()="       << m_vector.size()      << endl
+// Print the information of a word list.
+template <typename Words>
+void print(const Words &m_words) {
+    cout << "capacity()="   << m_words.capacity()   << endl
+         << "size()="       << m_words.size()       << endl
          << "array=[ ";
-    for(vector_t<string_t>::iterator it = m_vector.begin();
-        it != m_vector.end(); it++)  { cout << *it  << " "; }
+    for(typename Words::const_iterator it = m_words.begin();
+        it != m_words.end(); it++)  { cout << *it  << " "; }
     cout << "]"                             << endl << endl;
 }
 
-int main(int argc, char **argv) {
-    // Execution command message.
-    if(argc > 2) { cerr << "Usage: " << argv[0] << " <input_file>" << endl; exit(1); }
+// First character of a word, or 0 if it is empty.
+char initial(const string_t &m_word) { return m_word[0]; }
+char initial(const string_view &m_word) { return m_word.empty() ? 0 : m_word[0]; }
 
-    // Open a text file.
-    ifstream input_file;
-    input_file.open(argc == 2 ? argv[1] : "input");
-    if(!input_file.is_open()) { cerr << "Error: failed to open " << argv[1] << endl; exit(1); }
+// Run the workflow on a word list of vector_t<string_t> or string_column_t.
+template <typename Words>
+void run(const word_file_t &m_input_file) {
+    // Create word lists.
+    Words words, sorted;
 
-    // Create string vectors.
-    vector_t<string_t> words, sorted;
-
-    // Push words to a vector, 'words'.
-    char line[WORD_SIZE];
-    while(input_file.getline(line, WORD_SIZE)) { words.push_back(line); }
+    // Push words to a list, 'words'.
+    vector_t<string_view> lines;
+    m_input_file.lines(lines);
+    for(size_t i = 0; i < lines.size(); i++) { words.push_back(typename Words::value_type(lines[i])); }
     print(words);
 
-    // Close the text file.
-    input_file.close();
-
     // Remove words starting with 'a', 'e', 'i', 'o', 'u'.
-    for(vector_t<string_t>::iterator it = words.begin(); it != words.end(); it++) {
-        if(((*it)[0] == 'a') || ((*it)[0] == 'e') || ((*it)[0] == 'i') ||
-           ((*it)[0] == 'o') || ((*it)[0] == 'u')) { words.erase(it--); }
-    }
+    words.erase_if([](const auto &m_word) {
+        const char c = initial(m_word);
+        return (c == 'a') || (c == 'e') || (c == 'i') || (c == 'o') || (c == 'u'); });
     print(words);
 
-    // Insert words to a vector, 'sorted', in ascending order.
+    // Insert words to a list, 'sorted', in ascending order.
     sorted.reserve(words.size());
     for(size_t i = 0; i < words.size(); i++) {
-        vector_t<string_t>::iterator it = sorted.begin();
-        while((it != sorted.end()) && (words[i] > *it)) { it++; }
-        sorted.insert(it, words[i]);
+        sorted.insert(lower_bound(sorted.begin(), sorted.end(), words[i]), words[i]);
     }
     print(sorted);
 
     // Remove words starting with 'z'.
-    while(sorted.size() && (sorted[sorted.size()-1][0] == 'z')) { sorted.pop_back(); }
+    while(sorted.size() && (initial(sorted[sorted.size()-1]) == 'z')) { sorted.pop_back(); }
     print(sorted);
 
     // Blow up everything.
     sorted.clear();
     print(sorted);
 
-    // Copy the empty vector.
+    // Copy the empty list.
     words = sorted;
     print(words);
-    
-    return 0;
 }
 
+int main(int argc, char **argv) {
+    // "-c" runs the workflow on the columnar layout, string_column_t.
+    bool column = (argc > 1) && !strcmp(argv[1], "-c");
+    if(column) { argc--; argv++; }
+
+    // Execution command message.
+    if(argc > 2) { cerr << "Usage: " << argv[0] << " [-c] <input_file>" << endl; exit(1); }
+
+    // Map a text file.
+    const char *input_name = argc == 2 ? argv[1] : "input";
+    word_file_t input_file;
+    if(!input_file.open(input_name)) { cerr << "Error: failed to open " << input_name << endl; exit(1); }
+
+    if(column) { run<string_column_t>(input_file); }
+    else       { run<vector_t<string_t> >(input_file); }
+
+    // Unmap the text file.
+    input_file.close();
+
+    return 0;
+}
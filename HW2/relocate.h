@@ -0,0 +1,48 @@
+/* relocate.h */
+#ifndef __RELOCATE_H__
+#define __RELOCATE_H__
+
+#include <cstddef> // size_t
+#include <cstring> // memmove
+#include <new>     // placement new
+#include <type_traits>
+#include <utility> // std::move_if_noexcept, std::pair
+
+// Relocation trait
+// An object of a relocatable type may be moved to another address by
+// copying its bytes, after which the source is raw memory that needs no
+// destructor call. Trivially copyable types are relocatable, and other
+// types opt in by specializing the trait (e.g., string_t).
+template <typename T>
+struct is_relocatable : std::is_trivially_copyable<T> { };
+
+// A pair is relocatable if both of its members are.
+template <typename T1, typename T2>
+struct is_relocatable<std::pair<T1, T2> > :
+    std::integral_constant<bool, is_relocatable<T1>::value && is_relocatable<T2>::value> { };
+
+// Move 'm_count' elements from 'm_src' to the raw memory at 'm_dst', and
+// end the lifetime of the sources. The two ranges may overlap.
+// Relocatable elements take a single memmove, and the others are moved
+// one at a time unless their move constructor may throw.
+template <typename T>
+void relocate(T *m_dst, T *m_src, const size_t m_count) {
+    if((m_dst == m_src) || !m_count) { return; }
+    if(is_relocatable<T>::value) {
+        memmove((void*)m_dst, (const void*)m_src, sizeof(T) * m_count);
+    }
+    else if(m_dst < m_src) {
+        for(size_t i = 0; i < m_count; i++) {
+            new (&m_dst[i]) T(std::move_if_noexcept(m_src[i]));
+            m_src[i].~T();
+        }
+    }
+    else {
+        for(size_t i = m_count; i > 0; i--) {
+            new (&m_dst[i-1]) T(std::move_if_noexcept(m_src[i-1]));
+            m_src[i-1].~T();
+        }
+    }
+}
+
+#endif
@@ -1,49 +1,137 @@
 #include <cstdlib>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include "string.h"
 
 // Minimal implementation of string
-string_t::string_t() : ptr(0), length(0) {
+string_t::string_t() :
+    length(0),
+    hashed(0),
+    key(0),
+    res(0) {
+    buffer[0] = 0;
+}
+
+string_t::string_t(memory_resource_t *m_resource) :
+    length(0),
+    hashed(0),
+    key(0),
+    res(m_resource) {
+    buffer[0] = 0;
 }
 
 string_t::string_t(const string_t &m_string) :
-    ptr(0),
-    length(m_string.length) {
-    if(length) {
-        ptr = (char*)malloc(length+1);
-        strcpy(ptr, m_string.ptr);
-    }
+    length(0),
+    hashed(0),
+    key(0),
+    res(0) {
+    assign(m_string.data(), m_string.length);
 }
 
-string_t::string_t(const char *m_char) :
-    ptr(0),
-    length(strlen(m_char)) {
-    if(length) {
-        ptr = (char*)malloc(length+1);
-        strcpy(ptr, m_char);
-    }
+string_t::string_t(const char *m_char, memory_resource_t *m_resource) :
+    length(0),
+    hashed(0),
+    key(0),
+    res(m_resource) {
+    assign(m_char, strlen(m_char));
+}
+
+string_t::string_t(const std::string_view m_str, memory_resource_t *m_resource) :
+    length(0),
+    hashed(0),
+    key(0),
+    res(m_resource) {
+    assign(m_str.data(), m_str.size());
+}
+
+// A long string hands over its heap buffer, and a short one is copied.
+string_t::string_t(string_t &&m_string) noexcept :
+    key(0),
+    res(m_string.res) {
+    steal(m_string);
 }
 
 string_t::~string_t() {
-    free(ptr);
+    if(length > SSO_SIZE) { release(ptr, length+1); }
 }
 
 string_t& string_t::operator=(const string_t &m_string) {
-    if(m_string.ptr != ptr) {
-        free(ptr);
-        length = m_string.length;
-        ptr = (char*)malloc(length+1);
-        strcpy(ptr, m_string.ptr);
-    }
+    if(&m_string != this) { assign(m_string.data(), m_string.length); }
     return *this;
 }
 
 string_t& string_t::operator=(const char *m_char) {
-    if(m_char != ptr) {
-        free(ptr);
-        length = strlen(m_char);
-        ptr = (char*)malloc(length+1);
-        strcpy(ptr, m_char);
-    }
+    if(m_char != data()) { assign(m_char, strlen(m_char)); }
     return *this;
 }
 
+// As in the move constructor, the heap buffer is taken over together with
+// its memory resource, so a move never allocates.
+string_t& string_t::operator=(string_t &&m_string) noexcept {
+    if(&m_string == this) { return *this; }
+    if(length > SSO_SIZE) { release(ptr, length+1); }
+    res = m_string.res;
+    steal(m_string);
+    return *this;
+}
+
+// Short strings go to the inline buffer, and long ones to a new heap
+// buffer. The old heap buffer is released last, so 'm_char' may point
+// into this string.
+void string_t::assign(const char *m_char, const size_t m_length) {
+    if(m_length >= UINT32_MAX) { throw std::length_error("string_t: longer than 4 GB"); }
+    char *old = length > SSO_SIZE ? ptr : 0;
+    const size_t old_bytes = length+1;
+    if(m_length > SSO_SIZE) {
+        char *heap = acquire(m_length+1);
+        memcpy(heap, m_char, m_length);
+        heap[m_length] = 0;
+        ptr = heap;
+    }
+    else {
+        memmove(buffer, m_char, m_length);
+        buffer[m_length] = 0;
+    }
+    length = m_length;
+    hashed = (uint32_t)hash_chars(data(), m_length);
+    key = make_key(data(), m_length);
+    if(old) { release(old, old_bytes); }
+}
+
+// The key changes only with the first KEY_SIZE characters, but the hash
+// covers every character and is computed again.
+void string_t::set(const size_t m_index, const char m_char) {
+    data()[m_index] = m_char;
+    if(m_index < KEY_SIZE) { key = make_key(data(), length); }
+    hashed = (uint32_t)hash_chars(data(), length);
+}
+
+void string_t::steal(string_t &m_string) noexcept {
+    memcpy(buffer, m_string.buffer, sizeof(buffer));
+    length = m_string.length;
+    hashed = m_string.hashed;
+    key = m_string.key;
+    m_string.buffer[0] = 0;
+    m_string.length = 0;
+    m_string.hashed = 0;
+    m_string.key = 0;
+}
+
+// Find the first differing byte 16 at a time, and compare the last
+// partial block with memcmp().
+int string_t::compare_chars(const char *m_lhs, const char *m_rhs, const size_t m_length) {
+    size_t i = 0;
+#ifdef __SSE2__
+    for(; i + 16 <= m_length; i += 16) {
+        const __m128i lhs = _mm_loadu_si128((const __m128i*)(m_lhs + i));
+        const __m128i rhs = _mm_loadu_si128((const __m128i*)(m_rhs + i));
+        const unsigned differ = _mm_movemask_epi8(_mm_cmpeq_epi8(lhs, rhs)) ^ 0xffff;
+        if(differ) {
+            const size_t j = i + __builtin_ctz(differ);
+            return (unsigned char)m_lhs[j] - (unsigned char)m_rhs[j];
+        }
+    }
+#endif
+    return memcmp(m_lhs + i, m_rhs + i, m_length - i);
+}
@@ -1,40 +1,179 @@
+#ifndef __STRING_T_H__
+#define __STRING_T_H__
+
+#include <algorithm>
+#include <cstdint>
 #include <cstring>
 #include <iostream>
+#include <new>
+#include <stdexcept>
+#include <string_view>
+#include "allocator.h"
+#include "relocate.h"
 
 // Minimal implementation of string
+// Strings of up to SSO_SIZE characters are stored inside the object
+// (small-string optimization), so only longer ones allocate a heap buffer.
+// Heap buffers come from the string's memory resource, or from malloc()
+// if it has none. A copy uses malloc(), and a move keeps the resource,
+// taking it along with the buffer on assignment as well.
+// The first 8 characters are cached as a big-endian key, so most
+// comparisons are decided by one integer compare without reading the
+// characters. Only ties compare the rest, 16 bytes at a time with SSE2.
+// A 32-bit hash of the characters is also kept for hash containers, and
+// the length shares its 8 bytes, so strings are limited to 4 GB.
 class string_t {
 public:
     string_t();
+    explicit string_t(memory_resource_t *m_resource);
     string_t(const string_t &m_string);
-    string_t(const char *m_char);
+    string_t(const char *m_char, memory_resource_t *m_resource = 0);
+    explicit string_t(const std::string_view m_str, memory_resource_t *m_resource = 0);
+    string_t(string_t &&m_string) noexcept;
     ~string_t();
 
     string_t& operator=(const string_t &m_string);
     string_t& operator=(const char *m_char);
+    string_t& operator=(string_t &&m_string) noexcept;
     bool operator<(const string_t &m_string) const;
     bool operator>(const string_t &m_string) const;
-    char& operator[](const size_t m_index) const;
+    bool operator==(const string_t &m_string) const;
+    bool operator!=(const string_t &m_string) const;
+    // Characters are read-only, since they are cached in the key.
+    const char& operator[](const size_t m_index) const;
+    // Change the character at 'm_index', and update the key and hash.
+    void set(const size_t m_index, const char m_char);
+    // Compare with 'm_string', and return <0, 0, or >0 as memcmp().
+    int compare(const string_t &m_string) const;
+    // Get the number of characters.
+    size_t size() const { return length; }
+    // Get the NUL-terminated characters.
+    const char* c_str() const { return data(); }
+    // Get the cached hash of the characters.
+    size_t hash() const { return hashed; }
+    // Hash 'm_length' characters, wyhash-style. hash() keeps the low 32 bits.
+    static uint64_t hash_chars(const char *m_char, const size_t m_length);
+    // Get the memory resource of heap buffers (null for malloc).
+    memory_resource_t* resource() const { return res; }
 
 private:
-    char *ptr;
-    size_t length;
+    // Pointer to the characters, inline or on the heap
+    char* data() const { return length > SSO_SIZE ? ptr : const_cast<char*>(buffer); }
+    // Replace the contents with 'm_length' characters from 'm_char'.
+    void assign(const char *m_char, const size_t m_length);
+    // First KEY_SIZE characters as a big-endian number, zero-padded
+    static uint64_t make_key(const char *m_char, const size_t m_length);
+    // Compare 'm_length' characters, and return <0, 0, or >0 as memcmp().
+    static int compare_chars(const char *m_lhs, const char *m_rhs, const size_t m_length);
+    // Take over the contents of 'm_string', leaving it empty.
+    void steal(string_t &m_string) noexcept;
+    // Allocate and free heap buffers of 'm_bytes'.
+    char* acquire(const size_t m_bytes) {
+        char *heap = (char*)(res ? res->allocate(m_bytes) : malloc(m_bytes));
+        if(!heap) { throw std::bad_alloc(); }
+        return heap;
+    }
+    void release(char *m_ptr, const size_t m_bytes) { if(res) { res->deallocate(m_ptr, m_bytes); } else { free(m_ptr); } }
+
+    static const size_t SSO_SIZE = 15;  // Longest string stored inline
+    static const size_t KEY_SIZE = 8;   // Characters cached in the key
+    union {
+        char *ptr;                      // Heap buffer of a long string
+        char buffer[SSO_SIZE + 1];      // Inline characters of a short string
+    };
+    uint32_t length;
+    uint32_t hashed;                    // Low 32 bits of hash_chars()
+    uint64_t key;                       // First KEY_SIZE characters, for ordering
+    memory_resource_t *res;             // Source of heap buffers, or null for malloc()
 
 friend std::ostream& operator<<(std::ostream &m_os, const string_t &m_string);
 };
 
+// A string_t holds no pointer into itself, so its bytes may be moved.
+template <>
+struct is_relocatable<string_t> : std::true_type { };
+
+inline uint64_t string_t::make_key(const char *m_char, const size_t m_length) {
+    uint64_t key = 0;
+    memcpy(&key, m_char, m_length < KEY_SIZE ? m_length : KEY_SIZE);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    key = __builtin_bswap64(key);
+#endif
+    return key;
+}
+
+// Mix two words by a 64x64->128-bit multiply, and fold the halves.
+inline uint64_t hash_mix(const uint64_t m_a, const uint64_t m_b) {
+    const __uint128_t product = (__uint128_t)m_a * m_b;
+    return (uint64_t)product ^ (uint64_t)(product >> 64);
+}
+
+// Short strings read two overlapping pairs of 4-byte words, and longer
+// ones 16 bytes per round and then the last 16 bytes. The empty string is 0.
+inline uint64_t string_t::hash_chars(const char *m_char, const size_t m_length) {
+    static const uint64_t SECRET[] = { 0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull };
+    const unsigned char *p = (const unsigned char*)m_char;
+    uint64_t seed = SECRET[0] ^ m_length, a, b;
+    uint32_t w[4];
+    if(!m_length) { return 0; }
+    if(m_length <= 16) {
+        if(m_length >= 4) {
+            const size_t step = (m_length >> 3) << 2;
+            memcpy(&w[0], p, 4); memcpy(&w[1], p + step, 4);
+            memcpy(&w[2], p + m_length - 4, 4); memcpy(&w[3], p + m_length - 4 - step, 4);
+            a = ((uint64_t)w[0] << 32) | w[1];
+            b = ((uint64_t)w[2] << 32) | w[3];
+        }
+        else {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[m_length >> 1] << 8) | p[m_length-1];
+            b = 0;
+        }
+    }
+    else {
+        size_t rest = m_length;
+        for(; rest > 16; rest -= 16, p += 16) {
+            memcpy(&a, p, 8); memcpy(&b, p + 8, 8);
+            seed = hash_mix(a ^ SECRET[1], b ^ seed);
+        }
+        memcpy(&a, p + rest - 16, 8); memcpy(&b, p + rest - 8, 8);
+    }
+    return hash_mix(SECRET[1] ^ m_length, hash_mix(a ^ SECRET[1], b ^ seed ^ SECRET[2]));
+}
+
+// Equal keys mean equal first characters, so only longer strings read them.
+inline int string_t::compare(const string_t &m_string) const {
+    if(key != m_string.key) { return key < m_string.key ? -1 : 1; }
+    const size_t common = std::min(length, m_string.length);
+    if(common > KEY_SIZE) {
+        int result = compare_chars(data() + KEY_SIZE, m_string.data() + KEY_SIZE, common - KEY_SIZE);
+        if(result) { return result; }
+    }
+    return (length > m_string.length) - (length < m_string.length);
+}
+
 inline bool string_t::operator<(const string_t &m_string) const {
-    return strcmp(ptr, m_string.ptr) < 0;
+    return compare(m_string) < 0;
 }
 
 inline bool string_t::operator>(const string_t &m_string) const {
-    return strcmp(ptr, m_string.ptr) > 0;
+    return compare(m_string) > 0;
+}
+
+inline bool string_t::operator==(const string_t &m_string) const {
+    return (key == m_string.key) && (length == m_string.length) &&
+           ((length <= KEY_SIZE) || !compare_chars(data() + KEY_SIZE, m_string.data() + KEY_SIZE, length - KEY_SIZE));
+}
+
+inline bool string_t::operator!=(const string_t &m_string) const {
+    return !(*this == m_string);
 }
 
-inline char& string_t::operator[](const size_t m_index) const {
-    return ptr[m_index];
+inline const char& string_t::operator[](const size_t m_index) const {
+    return data()[m_index];
 }
 
 inline std::ostream& operator<<(std::ostream &m_os, const string_t &m_string) {
-    return m_os << m_string.ptr;
+    return m_os << m_string.data();
 }
 
+#endif
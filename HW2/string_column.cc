@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include "string_column.h"
+
+string_column_t::string_column_t(void) :
+    garbage(0) {
+    // Nothing to do
+}
+
+// Remove all elements.
+void string_column_t::clear(void) {
+    spans.clear();
+    blob.clear();
+    garbage = 0;
+}
+
+// Add a new element at the end.
+void string_column_t::push_back(const std::string_view m_str) {
+    span_t span = append(m_str);
+    spans.push_back(span);
+}
+
+// Remove the last element. Its characters are dropped at once if they
+// are the last ones in the blob.
+void string_column_t::pop_back(void) {
+    if(!spans.size()) { return; }
+    const span_t span = spans[spans.size()-1];
+    spans.pop_back();
+    if(span.offset + span.length + 1 == blob.size()) {
+        blob.erase(blob.begin() + span.offset, blob.end());
+    }
+    else { discard(span.length + 1); }
+}
+
+// Add a new element at the location pointed by the iterator.
+string_column_t::const_iterator string_column_t::insert(const_iterator m_it, const std::string_view m_str) {
+    const size_t index = m_it - begin();
+    span_t span = append(m_str);
+    spans.insert(spans.begin() + index, span);
+    return begin() + index;
+}
+
+// Erase an element at the location pointed by the iterator.
+string_column_t::const_iterator string_column_t::erase(const_iterator m_it) {
+    return erase(m_it, m_it + 1);
+}
+
+// Erase the elements in [m_first, m_last).
+string_column_t::const_iterator string_column_t::erase(const_iterator m_first, const_iterator m_last) {
+    const size_t first = m_first - begin(), last = m_last - begin();
+    size_t bytes = 0;
+    for(size_t i = first; i < last; i++) { bytes += spans[i].length + 1; }
+    spans.erase(spans.begin() + first, spans.begin() + last);
+    discard(bytes);
+    return begin() + first;
+}
+
+// Sort the elements in ascending order. Only the 8-byte spans move.
+void string_column_t::sort(void) {
+    const char *base = data();
+    std::sort(spans.begin(), spans.end(), [base](const span_t &m_a, const span_t &m_b) {
+        return std::string_view(base + m_a.offset, m_a.length) < std::string_view(base + m_b.offset, m_b.length); });
+}
+
+// Drop erased characters from the blob, and store the elements in order.
+void string_column_t::compact(void) {
+    vector_t<char> packed;
+    packed.reserve(blob.size() - garbage);
+    for(size_t i = 0; i < spans.size(); i++) {
+        const char *chars = &blob[spans[i].offset];
+        spans[i].offset = packed.size();
+        packed.insert(packed.end(), chars, chars + spans[i].length + 1);
+    }
+    blob = std::move(packed);
+    garbage = 0;
+}
+
+// Copy a string to the end of the blob. It may be part of the blob.
+string_column_t::span_t string_column_t::append(const std::string_view m_str) {
+    const size_t need = blob.size() + m_str.size() + 1;
+    if(need > UINT32_MAX) { throw std::length_error("string_column_t: blob exceeds 4 GB"); }
+
+    // Grow first, so that a source inside the blob is found again after the move.
+    const char *base = data();
+    const bool inside = base && (m_str.data() >= base) && (m_str.data() < base + blob.size());
+    const size_t source = inside ? m_str.data() - base : 0;
+    if(need > blob.capacity()) { blob.reserve(std::max(need, 2 * blob.capacity())); }
+    const char *chars = inside ? data() + source : m_str.data();
+
+    span_t span;
+    span.offset = blob.size();
+    span.length = m_str.size();
+    blob.insert(blob.end(), chars, chars + m_str.size());
+    blob.push_back(0);
+    return span;
+}
+
+// Count erased characters, and compact the blob once they are half of it.
+void string_column_t::discard(const size_t m_bytes) {
+    garbage += m_bytes;
+    if(garbage && (2 * garbage >= blob.size())) { compact(); }
+}
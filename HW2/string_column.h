@@ -0,0 +1,127 @@
+#ifndef __STRING_COLUMN_H__
+#define __STRING_COLUMN_H__
+
+#include <cstddef>     // ptrdiff_t
+#include <cstdint>     // uint32_t
+#include <iterator>    // random_access_iterator_tag
+#include <string_view>
+#include "vector.h"
+
+// Columnar list of strings
+// The characters of all strings live back to back, each followed by a
+// NUL, in one growable blob, and every element is an (offset, length)
+// span into it. Elements are read as std::string_view. Sorting, inserting
+// and erasing move only spans. Erased characters stay in the blob until
+// they make up half of it, and the blob is then compacted. The blob is
+// limited to 4 GB by the 32-bit offsets.
+class string_column_t {
+public:
+    // Location of one string in the blob
+    struct span_t {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    // Random-access iterator over the elements as std::string_view
+    class const_iterator {
+    friend class string_column_t;
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef std::string_view                value_type;
+        typedef std::ptrdiff_t                  difference_type;
+        typedef const std::string_view*         pointer;
+        typedef std::string_view                reference;
+
+        const_iterator(void) : span(0), blob(0) { /* Nothing to do */ }
+
+        std::string_view operator*(void) const { return std::string_view(blob + span->offset, span->length); }
+        std::string_view operator[](const difference_type m_n) const { return *(*this + m_n); }
+        const_iterator& operator++(void) { ++span; return *this; }
+        const_iterator operator++(int) { const_iterator it = *this; ++span; return it; }
+        const_iterator& operator--(void) { --span; return *this; }
+        const_iterator operator--(int) { const_iterator it = *this; --span; return it; }
+        const_iterator& operator+=(const difference_type m_n) { span += m_n; return *this; }
+        const_iterator& operator-=(const difference_type m_n) { span -= m_n; return *this; }
+        const_iterator operator+(const difference_type m_n) const { const_iterator it = *this; return it += m_n; }
+        const_iterator operator-(const difference_type m_n) const { const_iterator it = *this; return it -= m_n; }
+        difference_type operator-(const const_iterator &m_it) const { return span - m_it.span; }
+        bool operator==(const const_iterator &m_it) const { return span == m_it.span; }
+        bool operator!=(const const_iterator &m_it) const { return span != m_it.span; }
+        bool operator<(const const_iterator &m_it) const { return span < m_it.span; }
+        bool operator>(const const_iterator &m_it) const { return span > m_it.span; }
+        bool operator<=(const const_iterator &m_it) const { return span <= m_it.span; }
+        bool operator>=(const const_iterator &m_it) const { return span >= m_it.span; }
+
+    private:
+        const_iterator(const span_t *m_span, const char *m_blob) : span(m_span), blob(m_blob) { }
+        const span_t *span;
+        const char *blob;
+    };
+    typedef const_iterator iterator;
+    typedef std::string_view value_type;
+
+    string_column_t(void);
+
+    // Get the number of elements.
+    size_t size(void) const { return spans.size(); }
+    // Get the allocated number of elements.
+    size_t capacity(void) const { return spans.capacity(); }
+    // Get the number of characters in the blob, including separators and erased ones.
+    size_t blob_size(void) const { return blob.size(); }
+    // Reserve space for the given number of elements.
+    void reserve(const size_t m_size) { spans.reserve(m_size); }
+    // Remove all elements.
+    void clear(void);
+    // Get the element at the given index.
+    std::string_view operator[](const size_t m_index) const { return view(spans[m_index]); }
+    // Get an iterator pointing to the first element.
+    const_iterator begin(void) const { return const_iterator(spans.size() ? &spans[0] : 0, data()); }
+    // Get an iterator pointing to the next of last element.
+    const_iterator end(void) const { return begin() + spans.size(); }
+
+    // Add a new element at the end.
+    void push_back(const std::string_view m_str);
+    // Remove the last element.
+    void pop_back(void);
+    // Add a new element at the location pointed by the iterator.
+    const_iterator insert(const_iterator m_it, const std::string_view m_str);
+    // Erase an element at the location pointed by the iterator.
+    const_iterator erase(const_iterator m_it);
+    // Erase the elements in [m_first, m_last).
+    const_iterator erase(const_iterator m_first, const_iterator m_last);
+    // Erase all elements satisfying the predicate, and return the number of erased elements.
+    template <typename Pred>
+    size_t erase_if(Pred m_pred);
+    // Sort the elements in ascending order by permuting the spans.
+    void sort(void);
+    // Drop erased characters from the blob, and store the elements in order.
+    void compact(void);
+
+private:
+    // Pointer to the blob
+    const char* data(void) const { return blob.size() ? &blob[0] : 0; }
+    // Characters of a span
+    std::string_view view(const span_t &m_span) const { return std::string_view(data() + m_span.offset, m_span.length); }
+    // Copy a string to the end of the blob. It may be part of the blob.
+    span_t append(const std::string_view m_str);
+    // Count erased characters, and compact the blob once they are half of it.
+    void discard(const size_t m_bytes);
+
+    vector_t<span_t> spans;     // Elements in order
+    vector_t<char> blob;        // Characters of all strings, each followed by a NUL
+    size_t garbage;             // Erased characters in the blob
+};
+
+// Erase all elements satisfying the predicate.
+template <typename Pred>
+size_t string_column_t::erase_if(Pred m_pred) {
+    size_t bytes = 0;
+    size_t erased = spans.erase_if([&](const span_t &m_span) {
+        if(!m_pred(view(m_span))) { return false; }
+        bytes += m_span.length + 1;
+        return true; });
+    discard(bytes);
+    return erased;
+}
+
+#endif
@@ -1,52 +1,105 @@
 #ifndef __VECTOR_H__
 #define __VECTOR_H__
 
+#include "allocator.h"
 #include "iterator.h"
+#include "relocate.h"
 
-template <typename T>
+// Elements live in memory from an allocator, malloc() by default.
+template <typename T, typename Alloc = malloc_allocator_t>
 class vector_t {
 public:
     // Constructor
-    vector_t(void);
+    vector_t(const Alloc &m_alloc = Alloc());
     // Copy constructor
-    vector_t(const vector_t<T> &m_vector);
+    vector_t(const vector_t<T, Alloc> &m_vector);
+    // Move constructor
+    vector_t(vector_t<T, Alloc> &&m_vector) noexcept;
     // Destructor
     ~vector_t(void);
 
-    // vector_t<T>::iterator
+    // vector_t<T>::value_type, vector_t<T>::iterator and vector_t<T>::const_iterator
+    typedef T value_type;
     typedef iterator_t<T> iterator;
+    typedef iterator_t<const T> const_iterator;
 
     // Get the number of elements in the array.
     size_t size(void) const;
     // Get the allocated size of array in unit of elements.
     size_t capacity(void) const;
+    // Get the allocator of the array.
+    const Alloc& get_allocator(void) const { return alloc; }
     // Reserve an array space for the given number of elements.
     void reserve(size_t m_array_size);
     // Remove all elements in the array.
     void clear(void);
     // Add a new element at the end of array.
     void push_back(const T &m_data);
+    void push_back(T &&m_data);
+    // Construct a new element in place at the end of array.
+    template <typename... Args>
+    void emplace_back(Args&&... m_args);
     // Remove the last element in the array.
     void pop_back(void);
     // Assign new contents to the array.
-    vector_t<T>& operator=(const vector_t<T> &m_vector);
+    vector_t<T, Alloc>& operator=(const vector_t<T, Alloc> &m_vector);
+    vector_t<T, Alloc>& operator=(vector_t<T, Alloc> &&m_vector) noexcept;
     // Get a reference of element at the given index.
     T& operator[](const size_t m_index) const;
     // Get an iterator pointing to the first element of array.
-    iterator begin(void) const;
+    iterator begin(void);
+    const_iterator begin(void) const;
+    const_iterator cbegin(void) const;
     // Get an iterator pointing to the next of last element.
-    iterator end(void) const;
+    iterator end(void);
+    const_iterator end(void) const;
+    const_iterator cend(void) const;
     // Add a new element at the location pointed by the iterator.
     iterator insert(iterator m_it, const T &m_data);
+    iterator insert(iterator m_it, T &&m_data);
+    // Construct a new element in place at the location pointed by the iterator.
+    template <typename... Args>
+    iterator emplace(iterator m_it, Args&&... m_args);
+    // Add copies of the elements in [m_first, m_last), which must not be
+    // in this vector, at the location pointed by the iterator.
+    template <typename ForwardIt>
+    iterator insert(iterator m_it, ForwardIt m_first, ForwardIt m_last);
     // Erase an element at the location pointed by the iterator.
     iterator erase(iterator m_it);
+    // Erase the elements in [m_first, m_last).
+    iterator erase(iterator m_first, iterator m_last);
+    // Erase all elements satisfying the predicate, and return the number of erased elements.
+    template <typename Pred>
+    size_t erase_if(Pred m_pred);
+    // Erase all but the first of each run of equal elements, and return the number of erased elements.
+    size_t unique(void);
+    template <typename BinaryPred>
+    size_t unique(BinaryPred m_equal);
 
 private:
+    // Get the index of the element pointed by the iterator.
+    size_t index_of(const_iterator m_it) const;
+    // Erase the elements for which m_remove(element, last kept element or null) is true.
+    template <typename Remove>
+    size_t compact(Remove m_remove);
+
+    Alloc alloc;            // Source of the array memory
     T *array;               // Data array
     size_t array_size;      // Allocated array size
     size_t num_elements;    // Number of elements in the array
 };
 
+// Erase all elements of the vector satisfying the predicate.
+template <typename T, typename Alloc, typename Pred>
+size_t remove_if(vector_t<T, Alloc> &m_vector, Pred m_pred) { return m_vector.erase_if(m_pred); }
+
+// Erase all but the first of each run of equal elements in the vector.
+template <typename T, typename Alloc>
+size_t unique(vector_t<T, Alloc> &m_vector) { return m_vector.unique(); }
+
+template <typename T, typename Alloc, typename BinaryPred>
+size_t unique(vector_t<T, Alloc> &m_vector, BinaryPred m_equal) { return m_vector.unique(m_equal); }
+
 #include "vector.hpp"
 
 #endif
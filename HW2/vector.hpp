@@ -2,12 +2,14 @@
 #ifndef __VECTOR_HPP__
 #define __VECTOR_HPP__
 
-#include <cstdlib> // malloc, free
 #include <new>     // placement new
+#include <iterator> // std::distance
+#include <utility> // std::move, std::forward, std::move_if_noexcept
 
 // Constructor
-template <typename T>
-vector_t<T>::vector_t(void) :
+template <typename T, typename Alloc>
+vector_t<T, Alloc>::vector_t(const Alloc &m_alloc) :
+    alloc(m_alloc),
     array(0),
     array_size(0),
     num_elements(0) {
@@ -15,48 +17,82 @@ vector_t<T>::vector_t(void) :
 }
 
 // Copy constructor
-template <typename T>
-vector_t<T>::vector_t(const vector_t<T> &m_vector) :
+template <typename T, typename Alloc>
+vector_t<T, Alloc>::vector_t(const vector_t<T, Alloc> &m_vector) :
+    alloc(m_vector.alloc),
     array(0),
     array_size(m_vector.num_elements),
     num_elements(m_vector.num_elements) {
     // Copy constructor creates a copy of tight-fit array.
-    array = (T*)malloc(sizeof(T) * array_size);
+    array = (T*)alloc.allocate(sizeof(T) * array_size);
     for(size_t i = 0; i < num_elements; i++) {
         new (&array[i]) T(m_vector.array[i]);
     }
 }
 
+// Move constructor
+template <typename T, typename Alloc>
+vector_t<T, Alloc>::vector_t(vector_t<T, Alloc> &&m_vector) noexcept :
+    alloc(m_vector.alloc),
+    array(m_vector.array),
+    array_size(m_vector.array_size),
+    num_elements(m_vector.num_elements) {
+    // Take over the array, leaving the source empty.
+    m_vector.array = 0;
+    m_vector.array_size = 0;
+    m_vector.num_elements = 0;
+}
+
 // Destructor
-template <typename T>
-vector_t<T>::~vector_t(void) {
+template <typename T, typename Alloc>
+vector_t<T, Alloc>::~vector_t(void) {
     // Destruct all elements first, and then free the array.
     for(size_t i = 0; i < num_elements; i++) { array[i].~T(); }
-    free(array);
+    alloc.deallocate(array, sizeof(T) * array_size);
 }
 
 // Get the number of elements in the array.
-template <typename T>
-inline size_t vector_t<T>::size(void) const { return num_elements; }
+template <typename T, typename Alloc>
+inline size_t vector_t<T, Alloc>::size(void) const { return num_elements; }
 
 // Get the allocated size of array in unit of elements.
-template <typename T>
-inline size_t vector_t<T>::capacity(void) const { return array_size; }
+template <typename T, typename Alloc>
+inline size_t vector_t<T, Alloc>::capacity(void) const { return array_size; }
 
 // Get a reference of element at the given index.
-template <typename T>
-inline T& vector_t<T>::operator[](const size_t m_index) const { return array[m_index]; }
+template <typename T, typename Alloc>
+inline T& vector_t<T, Alloc>::operator[](const size_t m_index) const { return array[m_index]; }
 
 // Get an iterator pointing to the first element of array.
-template <typename T>
-inline typename vector_t<T>::iterator vector_t<T>::begin(void) const {
-    return iterator_t<T>(array);
+template <typename T, typename Alloc>
+inline typename vector_t<T, Alloc>::iterator vector_t<T, Alloc>::begin(void) {
+    return iterator(array);
+}
+
+template <typename T, typename Alloc>
+inline typename vector_t<T, Alloc>::const_iterator vector_t<T, Alloc>::begin(void) const {
+    return const_iterator(array);
+}
+
+template <typename T, typename Alloc>
+inline typename vector_t<T, Alloc>::const_iterator vector_t<T, Alloc>::cbegin(void) const {
+    return const_iterator(array);
 }
 
 // Get an iterator pointing to the next of last element.
-template <typename T>
-inline typename vector_t<T>::iterator vector_t<T>::end(void) const {
-    return iterator_t<T>(array+num_elements);
+template <typename T, typename Alloc>
+inline typename vector_t<T, Alloc>::iterator vector_t<T, Alloc>::end(void) {
+    return iterator(array+num_elements);
+}
+
+template <typename T, typename Alloc>
+inline typename vector_t<T, Alloc>::const_iterator vector_t<T, Alloc>::end(void) const {
+    return const_iterator(array+num_elements);
+}
+
+template <typename T, typename Alloc>
+inline typename vector_t<T, Alloc>::const_iterator vector_t<T, Alloc>::cend(void) const {
+    return const_iterator(array+num_elements);
 }
 
 /*************************
@@ -64,33 +100,35 @@ inline typename vector_t<T>::iterator vector_t<T>::end(void) const {
  *************************/
 
 // Reserve an array space for the given number of elements.
-template <typename T>
-void vector_t<T>::reserve(size_t m_array_size) {
+template <typename T, typename Alloc>
+void vector_t<T, Alloc>::reserve(size_t m_array_size) {
     // Only proceed if the requested size is greater than the current capacity.
     if (m_array_size > array_size) {
-        // 1. Allocate new raw memory.
-        T *new_array = (T*)malloc(sizeof(T) * m_array_size);
-        
-        // 2. Deep copy existing elements to the new memory using Placement New.
-        for (size_t i = 0; i < num_elements; i++) {
-            new (&new_array[i]) T(array[i]); // Copy construct
-            array[i].~T();                   // Destruct old element
+        if (is_relocatable<T>::value) {
+            // Relocatable elements travel with the memory block, which
+            // the allocator may even extend in place.
+            array = (T*)alloc.reallocate((void*)array, sizeof(T) * array_size, sizeof(T) * m_array_size);
         }
+        else {
+            // 1. Allocate new raw memory.
+            T *new_array = (T*)alloc.allocate(sizeof(T) * m_array_size);
+
+            // 2. Relocate existing elements to the new memory.
+            relocate(new_array, array, num_elements);
 
-        // 3. Free the old memory block.
-        if (array != 0) {
-            free(array);
+            // 3. Free the old memory block.
+            alloc.deallocate(array, sizeof(T) * array_size);
+            array = new_array;
         }
 
-        // 4. Update pointers and capacity.
-        array = new_array;
+        // 4. Update capacity.
         array_size = m_array_size;
     }
 }
 
 // Remove all elements in the array.
-template <typename T>
-void vector_t<T>::clear(void) {
+template <typename T, typename Alloc>
+void vector_t<T, Alloc>::clear(void) {
     // Destruct all elements explicitly.
     for (size_t i = 0; i < num_elements; i++) {
         array[i].~T();
@@ -100,25 +138,37 @@ void vector_t<T>::clear(void) {
 }
 
 // Add a new element at the end of array.
-template <typename T>
-void vector_t<T>::push_back(const T &m_data) {
+template <typename T, typename Alloc>
+void vector_t<T, Alloc>::push_back(const T &m_data) { emplace_back(m_data); }
+
+template <typename T, typename Alloc>
+void vector_t<T, Alloc>::push_back(T &&m_data) { emplace_back(std::move(m_data)); }
+
+// Construct a new element in place at the end of array.
+template <typename T, typename Alloc>
+template <typename... Args>
+void vector_t<T, Alloc>::emplace_back(Args&&... m_args) {
     // 1. Check if the array is full.
     if (num_elements == array_size) {
+        // The arguments may refer to an element of this array, so build
+        // the new element before reserve() relocates the array.
+        T data(std::forward<Args>(m_args)...);
         // Double the capacity (start with 1 if empty).
-        size_t new_capacity = (array_size == 0) ? 1 : array_size * 2;
-        reserve(new_capacity);
+        reserve((array_size == 0) ? 1 : array_size * 2);
+        new (&array[num_elements]) T(std::move(data));
+    }
+    else {
+        // 2. Construct the new element at the end using Placement New.
+        new (&array[num_elements]) T(std::forward<Args>(m_args)...);
     }
 
-    // 2. Construct the new element at the end using Placement New.
-    new (&array[num_elements]) T(m_data);
-    
     // 3. Increment size.
     num_elements++;
 }
 
 // Remove the last element in the array.
-template <typename T>
-void vector_t<T>::pop_back(void) {
+template <typename T, typename Alloc>
+void vector_t<T, Alloc>::pop_back(void) {
     if (num_elements > 0) {
         // 1. Decrement size first to get the index of the last element.
         num_elements--;
@@ -129,8 +179,8 @@ void vector_t<T>::pop_back(void) {
 }
 
 // Assign new contents to the array.
-template <typename T>
-vector_t<T>& vector_t<T>::operator=(const vector_t<T> &m_vector) {
+template <typename T, typename Alloc>
+vector_t<T, Alloc>& vector_t<T, Alloc>::operator=(const vector_t<T, Alloc> &m_vector) {
     // 1. Check for self-assignment.
     if (this == &m_vector) {
         return *this;
@@ -145,8 +195,8 @@ vector_t<T>& vector_t<T>::operator=(const vector_t<T> &m_vector) {
     // To simplify and match the "tight-fit" behavior of the copy constructor, 
     // we can just reallocate to match the source's size exactly.
     if (array_size < m_vector.num_elements) {
-        if (array != 0) free(array);
-        array = (T*)malloc(sizeof(T) * m_vector.num_elements);
+        alloc.deallocate(array, sizeof(T) * array_size);
+        array = (T*)alloc.allocate(sizeof(T) * m_vector.num_elements);
         array_size = m_vector.num_elements;
     }
 
@@ -159,77 +209,172 @@ vector_t<T>& vector_t<T>::operator=(const vector_t<T> &m_vector) {
     return *this;
 }
 
+template <typename T, typename Alloc>
+vector_t<T, Alloc>& vector_t<T, Alloc>::operator=(vector_t<T, Alloc> &&m_vector) noexcept {
+    if (this != &m_vector) {
+        // Release the current contents, and take over the source array
+        // together with the allocator it came from.
+        for (size_t i = 0; i < num_elements; i++) { array[i].~T(); }
+        alloc.deallocate(array, sizeof(T) * array_size);
+        alloc = m_vector.alloc;
+        array = m_vector.array;
+        array_size = m_vector.array_size;
+        num_elements = m_vector.num_elements;
+        m_vector.array = 0;
+        m_vector.array_size = 0;
+        m_vector.num_elements = 0;
+    }
+    return *this;
+}
+
+// Get the index of the element pointed by the iterator.
+template <typename T, typename Alloc>
+inline size_t vector_t<T, Alloc>::index_of(vector_t<T, Alloc>::const_iterator m_it) const {
+    return m_it.ptr - array;
+}
+
 // Add a new element at the location pointed by the iterator.
-template <typename T>
-typename vector_t<T>::iterator vector_t<T>::insert(vector_t<T>::iterator m_it, const T &m_data) {
-    // Calculate the index from the iterator.
-    // Note: iterator_t is a wrapper around a pointer.
-    // Assuming m_it corresponds to a pointer inside our array range.
-    size_t index = 0;
-    // We need to manually calculate distance since we don't have direct pointer access via public API easily,
-    // but looking at iterator.h (implied), it wraps T*.
-    // Let's assume standard pointer arithmetic works on iterators or we use begin().
-    // Since we are inside vector_t, we can't access m_it private members directly unless friend.
-    // However, usually `m_it - begin()` works if operator- is defined.
-    // Given the skeleton, we assume standard iterator behavior.
-    
-    // Workaround: Iterate to find index if operator- is missing, 
-    // but typically for vector, `it - begin()` is standard.
-    // Let's assume iterator_t supports pointer subtraction or we have access.
-    // Looking at main.cc, it does `it++`.
-    
-    // Simple approach: Iterate from begin to find offset.
-    iterator it = begin();
-    while (it != m_it && it != end()) {
-        it++;
-        index++;
-    }
-    
+template <typename T, typename Alloc>
+typename vector_t<T, Alloc>::iterator vector_t<T, Alloc>::insert(vector_t<T, Alloc>::iterator m_it, const T &m_data) {
+    return emplace(m_it, m_data);
+}
+
+template <typename T, typename Alloc>
+typename vector_t<T, Alloc>::iterator vector_t<T, Alloc>::insert(vector_t<T, Alloc>::iterator m_it, T &&m_data) {
+    return emplace(m_it, std::move(m_data));
+}
+
+// Construct a new element in place at the location pointed by the iterator.
+template <typename T, typename Alloc>
+template <typename... Args>
+typename vector_t<T, Alloc>::iterator vector_t<T, Alloc>::emplace(vector_t<T, Alloc>::iterator m_it, Args&&... m_args) {
+    size_t index = index_of(m_it);
+
+    // The arguments may refer to an element that is about to be shifted
+    // or relocated, so build the new element first.
+    T data(std::forward<Args>(m_args)...);
+
     // 1. Check capacity.
     if (num_elements == array_size) {
         reserve(array_size == 0 ? 1 : array_size * 2);
     }
 
-    // 2. Shift elements to the right (from back to index).
-    // We must construct new elements using placement new (copy/move).
-    for (size_t i = num_elements; i > index; i--) {
-        new (&array[i]) T(array[i-1]); // Copy construct to new slot
-        array[i-1].~T();               // Destruct old slot
-    }
+    // 2. Shift the elements from index to the right by one.
+    relocate(array + index + 1, array + index, num_elements - index);
 
     // 3. Insert new element.
-    new (&array[index]) T(m_data);
+    new (&array[index]) T(std::move(data));
     num_elements++;
 
     // 4. Return iterator to the inserted element.
     return iterator(array + index);
 }
 
-// Erase an element at the location pointed by the iterator.
-template <typename T>
-typename vector_t<T>::iterator vector_t<T>::erase(vector_t<T>::iterator m_it) {
-    // Calculate index.
-    iterator it = begin();
-    size_t index = 0;
-    while (it != m_it && it != end()) {
-        it++;
-        index++;
+// Add copies of the elements in [m_first, m_last) at the location pointed by the iterator.
+template <typename T, typename Alloc>
+template <typename ForwardIt>
+typename vector_t<T, Alloc>::iterator vector_t<T, Alloc>::insert(vector_t<T, Alloc>::iterator m_it, ForwardIt m_first, ForwardIt m_last) {
+    size_t index = index_of(m_it), count = std::distance(m_first, m_last);
+
+    // 1. Check capacity, growing at least twofold.
+    if (num_elements + count > array_size) {
+        reserve(num_elements + count > array_size * 2 ? num_elements + count : array_size * 2);
     }
 
-    // 1. Destruct the element at index.
-    array[index].~T();
+    // 2. Open a gap of 'count' elements at index with one shift.
+    relocate(array + index + count, array + index, num_elements - index);
 
-    // 2. Shift elements to the left (fill the gap).
-    for (size_t i = index; i < num_elements - 1; i++) {
-        new (&array[i]) T(array[i+1]); // Copy next into current
-        array[i+1].~T();               // Destruct next
+    // 3. Copy the new elements into the gap.
+    for (size_t i = index; m_first != m_last; m_first++, i++) {
+        new (&array[i]) T(*m_first);
     }
+    num_elements += count;
+
+    // 4. Return iterator to the first inserted element.
+    return iterator(array + index);
+}
+
+// Erase an element at the location pointed by the iterator.
+template <typename T, typename Alloc>
+typename vector_t<T, Alloc>::iterator vector_t<T, Alloc>::erase(vector_t<T, Alloc>::iterator m_it) {
+    iterator next = m_it;
+    return erase(m_it, ++next);
+}
+
+// Erase the elements in [m_first, m_last).
+template <typename T, typename Alloc>
+typename vector_t<T, Alloc>::iterator vector_t<T, Alloc>::erase(vector_t<T, Alloc>::iterator m_first, vector_t<T, Alloc>::iterator m_last) {
+    size_t first = index_of(m_first), last = index_of(m_last);
+
+    // 1. Destruct the erased elements.
+    for (size_t i = first; i < last; i++) { array[i].~T(); }
+
+    // 2. Shift the elements after them to the left with one shift.
+    relocate(array + first, array + last, num_elements - last);
 
     // 3. Decrement size.
-    num_elements--;
+    num_elements -= last - first;
 
-    // 4. Return iterator to the element following the erased one (now at index).
-    return iterator(array + index);
+    // 4. Return iterator to the element following the erased ones (now at first).
+    return iterator(array + first);
+}
+
+// Erase all elements satisfying the predicate.
+template <typename T, typename Alloc>
+template <typename Pred>
+size_t vector_t<T, Alloc>::erase_if(Pred m_pred) {
+    return compact([&m_pred](const T &m_data, const T*) { return m_pred(m_data); });
+}
+
+// Erase all but the first of each run of equal elements.
+template <typename T, typename Alloc>
+size_t vector_t<T, Alloc>::unique(void) {
+    return compact([](const T &m_data, const T *m_last) { return m_last && (*m_last == m_data); });
+}
+
+template <typename T, typename Alloc>
+template <typename BinaryPred>
+size_t vector_t<T, Alloc>::unique(BinaryPred m_equal) {
+    return compact([&m_equal](const T &m_data, const T *m_last) { return m_last && m_equal(*m_last, m_data); });
+}
+
+// Compact the array in one stable pass, testing each element once, and
+// return the number of erased elements. Every survivor is relocated at
+// most once.
+template <typename T, typename Alloc>
+template <typename Remove>
+size_t vector_t<T, Alloc>::compact(Remove m_remove) {
+    size_t kept = 0;
+    if (is_relocatable<T>::value) {
+        // Removed elements are destructed as they are found, and each run
+        // of survivors [run, i) moves down with one relocate().
+        size_t run = 0;
+        const T *last = 0;
+        for (size_t i = 0; i < num_elements; i++) {
+            if (!m_remove(array[i], last)) { last = &array[i]; continue; }
+            relocate(array + kept, array + run, i - run);
+            kept += i - run;
+            array[i].~T();
+            run = i + 1;
+            last = kept ? &array[kept-1] : 0;
+        }
+        relocate(array + kept, array + run, num_elements - run);
+        kept += num_elements - run;
+    }
+    else {
+        // Survivors are move-assigned over the removed elements, and the
+        // leftover elements at the end are destructed.
+        for (size_t i = 0; i < num_elements; i++) {
+            if (m_remove(array[i], kept ? &array[kept-1] : 0)) { continue; }
+            if (kept != i) { array[kept] = std::move(array[i]); }
+            kept++;
+        }
+        for (size_t i = kept; i < num_elements; i++) { array[i].~T(); }
+    }
+
+    size_t erased = num_elements - kept;
+    num_elements = kept;
+    return erased;
 }
 
 /*********************
@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "word_file.h"
+
+// Smallest chunk worth a thread of its own
+static const size_t CHUNK_SIZE = 1 << 20;
+
+// Add the lines in [m_first, m_last) to 'm_lines'. 'm_first' is the start of a line.
+static void split(const char *m_first, const char *m_last, vector_t<std::string_view> &m_lines) {
+    while(m_first < m_last) {
+        const char *newline = (const char*)memchr(m_first, '\n', m_last - m_first);
+        const char *end = newline ? newline : m_last;
+        const size_t size = end - m_first;
+        m_lines.push_back(std::string_view(m_first, size - (size && (end[-1] == '\r'))));
+        m_first = end + 1;
+    }
+}
+
+word_file_t::word_file_t(void) :
+    map(0),
+    length(0),
+    opened(false) {
+    // Nothing to do
+}
+
+word_file_t::~word_file_t(void) {
+    close();
+}
+
+// Map a file. An empty file cannot be mapped, and has no characters.
+bool word_file_t::open(const char *m_name) {
+    close();
+    int fd = ::open(m_name, O_RDONLY);
+    if(fd < 0) { return false; }
+    struct stat st;
+    if(fstat(fd, &st) < 0) { ::close(fd); return false; }
+    length = st.st_size;
+    if(length) {
+        void *ptr = mmap(0, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(ptr == MAP_FAILED) { ::close(fd); length = 0; return false; }
+        madvise(ptr, length, MADV_SEQUENTIAL);
+        map = (char*)ptr;
+    }
+    // The mapping stays valid after the descriptor is closed.
+    ::close(fd);
+    opened = true;
+    return true;
+}
+
+// Unmap the file.
+void word_file_t::close(void) {
+    if(map) { munmap(map, length); }
+    map = 0;
+    length = 0;
+    opened = false;
+}
+
+// Add every line to 'm_lines'. Each thread splits a chunk of at least
+// CHUNK_SIZE characters into its own list, moved forward to the start of
+// a line, and the lists are then appended in order.
+void word_file_t::lines(vector_t<std::string_view> &m_lines, const unsigned m_threads) const {
+    const size_t chunks = std::max<size_t>(1, std::min<size_t>(m_threads, length / CHUNK_SIZE));
+    if(chunks == 1) { split(map, map + length, m_lines); return; }
+
+    const char *end = map + length;
+    vector_t<const char*> bounds;
+    bounds.push_back(map);
+    for(size_t i = 1; i < chunks; i++) {
+        const char *bound = std::max<const char*>(map + length / chunks * i, bounds[i-1]);
+        if((bound > map) && (bound < end) && (bound[-1] != '\n')) {
+            const char *newline = (const char*)memchr(bound, '\n', end - bound);
+            bound = newline ? newline + 1 : end;
+        }
+        bounds.push_back(bound);
+    }
+    bounds.push_back(end);
+
+    vector_t<vector_t<std::string_view> > parts;
+    parts.reserve(chunks);
+    for(size_t i = 0; i < chunks; i++) { parts.emplace_back(); }
+    vector_t<std::thread> threads;
+    threads.reserve(chunks);
+    for(size_t i = 0; i < chunks; i++) {
+        threads.emplace_back(split, bounds[i], bounds[i+1], std::ref(parts[i]));
+    }
+    size_t total = m_lines.size();
+    for(size_t i = 0; i < chunks; i++) { threads[i].join(); total += parts[i].size(); }
+
+    m_lines.reserve(total);
+    for(size_t i = 0; i < chunks; i++) { m_lines.insert(m_lines.end(), parts[i].begin(), parts[i].end()); }
+}
@@ -0,0 +1,41 @@
+#ifndef __WORD_FILE_H__
+#define __WORD_FILE_H__
+
+#include <cstddef>
+#include <string_view>
+#include "vector.h"
+
+// Read-only memory map of a word file with one word per line
+// Lines are returned as std::string_view into the mapping, so loading
+// copies no characters, allocates nothing per word, and has no length
+// limit. Newlines are found with memchr(), which glibc vectorizes, and a
+// '\r' before a newline is dropped. The views are valid until the file is
+// closed. lines() can split a large file on several threads, each taking
+// a chunk that starts and ends at a line boundary.
+class word_file_t {
+public:
+    word_file_t(void);
+    ~word_file_t(void);
+    word_file_t(const word_file_t &m_file) = delete;
+    word_file_t& operator=(const word_file_t &m_file) = delete;
+
+    // Map a file, and return false if it cannot be opened or mapped.
+    bool open(const char *m_name);
+    // Unmap the file.
+    void close(void);
+    // Check if a file is mapped.
+    bool is_open(void) const { return opened; }
+    // Get the characters of the file.
+    const char* data(void) const { return map; }
+    // Get the number of characters in the file.
+    size_t size(void) const { return length; }
+    // Add every line to 'm_lines', splitting with up to 'm_threads' threads.
+    void lines(vector_t<std::string_view> &m_lines, const unsigned m_threads = 1) const;
+
+private:
+    char *map;          // Mapped characters, or null for an empty file
+    size_t length;      // Size of the file
+    bool opened;        // Whether a file is mapped
+};
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef __ALLOC_H__
+#define __ALLOC_H__
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Allocations of at least this many bytes are mapped and backed by huge pages where possible.
+const size_t ALLOC_MMAP_MIN = 1 << 21;
+
+// How a block was obtained
+enum alloc_kind { alloc_heap = 0,   // posix_memalign, 64-byte aligned
+                  alloc_hugetlb,    // mmap(MAP_HUGETLB) from the reserved huge page pool
+                  alloc_thp,        // mmap + madvise(MADV_HUGEPAGE), transparent huge pages
+                  alloc_pages };    // mmap with base pages only
+
+// Bookkeeping kept in the 64 bytes just below every block
+struct alignas(64) alloc_header_t {
+    void *base;         // Start of the underlying allocation
+    size_t length;      // Mapped length, for munmap
+    int kind;           // alloc_kind
+};
+
+// Huge page size from /proc/meminfo (2 MB if unknown)
+inline size_t huge_page_size() {
+    static size_t size = 0;
+    if(!size) {
+        size = 2 << 20;
+        std::ifstream fs("/proc/meminfo");
+        std::string key;
+        size_t value;
+        while(fs >> key >> value) {
+            if(key == "Hugepagesize:") { size = value << 10; break; }
+            fs.ignore(256, '\n');
+        }
+    }
+    return size;
+}
+
+// TLB-friendly size: 'bytes' rounded up to whole huge pages for mapped
+// blocks, or to whole base pages otherwise.
+inline size_t tlb_size(const size_t bytes) {
+    const size_t unit = bytes >= ALLOC_MMAP_MIN ? huge_page_size() : (size_t)sysconf(_SC_PAGESIZE);
+    return (bytes + unit - 1) / unit * unit;
+}
+
+// Zero [ptr, ptr + bytes) with 'num_threads' threads, each writing one
+// contiguous share, so that with first-touch placement every page lands
+// on the NUMA node of the thread that later works on that share.
+inline void first_touch(char *ptr, const size_t bytes, const unsigned num_threads) {
+    if(num_threads <= 1) { memset(ptr, 0, bytes); return; }
+    std::vector<std::thread> threads;
+    for(unsigned t = 0; t < num_threads; t++) {
+        size_t begin = bytes / num_threads * t, end = t + 1 == num_threads ? bytes : bytes / num_threads * (t + 1);
+        threads.push_back(std::thread([=]() { memset(ptr + begin, 0, end - begin); }));
+    }
+    for(unsigned t = 0; t < num_threads; t++) { threads[t].join(); }
+}
+
+// Allocate 'bytes' of zero-filled memory. Small blocks are 64-byte
+// aligned heap memory. Large blocks are mappings from the huge page pool
+// (64-byte aligned), or else huge-page aligned transparent huge pages, or
+// else base pages. With 'num_threads' > 1 the pages are first touched in parallel.
+inline void* alloc_bytes(const size_t bytes, const unsigned num_threads = 1) {
+    const size_t header = sizeof(alloc_header_t);
+    alloc_header_t info;
+    char *ptr = 0;
+
+    if(bytes < ALLOC_MMAP_MIN) {
+        void *base = 0;
+        if(posix_memalign(&base, header, header + bytes)) { throw std::bad_alloc(); }
+        info.base = base;
+        info.length = header + bytes;
+        info.kind = alloc_heap;
+        ptr = (char*)base + header;
+        first_touch(ptr, bytes, num_threads);
+    }
+    else {
+        const size_t huge = huge_page_size(), size = tlb_size(bytes);
+        // The header and the block share the huge pages: the header takes
+        // 64 bytes of the slack left by rounding up, so an extra huge page
+        // is mapped only when less than that is left.
+        info.length = tlb_size(header + bytes);
+        info.base = mmap(0, info.length, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0);
+        if(info.base != MAP_FAILED) {
+            info.kind = alloc_hugetlb;
+            ptr = (char*)info.base + header;
+        }
+        else {
+            // Over-map so that a huge-page aligned block fits after the header.
+            info.length = size + 2 * huge;
+            info.base = mmap(0, info.length, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+            if(info.base == MAP_FAILED) { throw std::bad_alloc(); }
+            ptr = (char*)(((uintptr_t)info.base + header + huge - 1) / huge * huge);
+            info.kind = madvise(ptr, size, MADV_HUGEPAGE) ? alloc_pages : alloc_thp;
+        }
+        // Mapped memory is already zero; touching it only places the pages.
+        if(num_threads > 1) { first_touch(ptr, bytes, num_threads); }
+    }
+
+    memcpy(ptr - header, &info, sizeof(info));
+    return ptr;
+}
+
+// Release a block from alloc_bytes().
+inline void free_bytes(void *ptr) {
+    if(!ptr) { return; }
+    alloc_header_t info;
+    memcpy(&info, (char*)ptr - sizeof(alloc_header_t), sizeof(info));
+    if(info.kind == alloc_heap) { free(info.base); }
+    else { munmap(info.base, info.length); }
+}
+
+// How a block from alloc_bytes() was obtained
+inline alloc_kind kind_of(const void *ptr) {
+    alloc_header_t info;
+    memcpy(&info, (const char*)ptr - sizeof(alloc_header_t), sizeof(info));
+    return (alloc_kind)info.kind;
+}
+
+// Typed wrappers. Zero-filled memory is the value-initialized state of
+// the arithmetic and std::complex element types these labs use.
+template <typename T>
+T* alloc_array(const size_t count, const unsigned num_threads = 1) {
+    return static_cast<T*>(alloc_bytes(count * sizeof(T), num_threads));
+}
+
+template <typename T>
+void free_array(T *ptr) { free_bytes(ptr); }
+
+#endif
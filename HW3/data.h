@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <fstream>
 #include <iostream>
+#include "alloc.h"
 
 template<typename T1, typename T2>
 void load(const char *file_name, T1 *&array, T2 &size) {
@@ -13,7 +14,7 @@ void load(const char *file_name, T1 *&array, T2 &size) {
         std::cerr << "Error: failed to open " << file_name << std::endl; std::exit(1);
     }
     fs.read((char*)&size, sizeof(T2));          // Read the number of data points.
-    array = new T1[size];                       // Allocate the array.
+    array = alloc_array<T1>(size);              // Allocate the array (huge pages if large).
     fs.read((char*)array, sizeof(T1)*size);     // Load data points.
     fs.close();                                 // Close the file.
 }
@@ -24,7 +25,7 @@ void fin(T1 *array, const T2 size) {
         std::cerr << "Error: array is not sorted" << std::endl; std::exit(1);
     }
     std::cout << "Done: array is sorted!" << std::endl;
-    delete [] array;                            // Deallocate the array.
+    free_array(array);                          // Deallocate the array.
 }
 
 #endif
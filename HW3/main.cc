@@ -1,17 +1,29 @@
 #include <cstdint>
 #include <iostream>
+#include <unistd.h>
 #include "data.h"
 #include "sort.h"
 #include "stopwatch.h"
 
 int main(int argc, char **argv) {
-    if((argc < 2) || (argc > 3)) {                          // Run command message
-        std::cerr << "Usage: " << argv[0] << " <num_threads> <data_file>" << std::endl;
+    wisdom_mode planner = wisdom_estimate;                  // Planner mode
+    const char *wisdom_file = "wisdom";                     // Wisdom file
+    bool bad_option = false;                                // Unknown command-line option
+    int opt;
+    while((opt = getopt(argc, argv, "p:w:")) != -1) {
+        switch(opt) {
+            case 'p': { bad_option |= !parse_wisdom_mode(optarg, planner); break; }
+            case 'w': { wisdom_file = optarg; break; }
+            default:  { bad_option = true; break; }
+        }
+    }
+    if(bad_option || (argc - optind < 1) || (argc - optind > 2)) { // Run command message
+        std::cerr << "Usage: " << argv[0] << " [-p estimate|measure|load] [-w <wisdom_file>] <num_threads> <data_file>" << std::endl;
         exit(1);
     }
 
-    unsigned num_threads  = (unsigned)std::stoi(argv[1]);   // Number of threads
-    const char *data_file = argc == 3 ? argv[2] : "data";   // Data file
+    unsigned num_threads  = (unsigned)std::stoi(argv[optind]);                  // Number of threads
+    const char *data_file = argc - optind == 2 ? argv[optind + 1] : "data";     // Data file
     int *array = 0; uint64_t size = 0;                      // Data array and size
     unsigned n = num_threads;                               // Max num_threads is 1024.
     if(n > 1024) {
@@ -25,6 +37,7 @@ int main(int argc, char **argv) {
     }
 
     load(data_file, array, size);                           // Load data to the array.
+    sort_config_t config = tune_sort(array, size, num_threads, planner, wisdom_file); // Pick sort parameters.
     
     //for(int i=0;i<10;i++) printf("%3dth -> %d\n",i, array[i]);
     
@@ -41,7 +54,7 @@ int main(int argc, char **argv) {
 
     stopwatch_t stopwatch;                                  // Measure time spent on sorting.
     stopwatch.start();
-    sort(array, size, num_threads);                         // Sort the array.
+    sort(array, size, num_threads, config);                 // Sort the array.
     stopwatch.stop();
     stopwatch.display();
     
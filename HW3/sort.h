@@ -10,6 +10,21 @@
 #include <thread>
 #include <vector>
 #include <iostream>
+#include <sstream>
+#include <string>
+#include "alloc.h"
+#include "wisdom.h"
+
+// Tuning parameters of the merge sort
+struct sort_config_t {
+    sort_config_t() : leaf_cutoff(16), grain(1 << 14) { }
+    size_t leaf_cutoff; // Ranges up to this size are insertion sorted.
+    size_t grain;       // Ranges below this size are not split across threads.
+};
+
+// Candidate values tried in measure mode
+const size_t leaf_candidates[] = { 1, 8, 16, 32, 64 };
+const size_t grain_candidates[] = { 0, 1 << 12, 1 << 14, 1 << 16 };
 
 // Helper function: Merges two sorted subarrays into a temporary buffer, then copies back.
 template <typename T>
@@ -43,23 +58,40 @@ void merge(T *array, T *temp, size_t left, size_t mid, size_t right) {
     }
 }
 
+// Helper function: Insertion Sort for small ranges
+template <typename T>
+void insertion_sort(T *array, size_t left, size_t right) {
+    for (size_t i = left + 1; i <= right; i++) {
+        T value = array[i];
+        size_t j = i;
+        while (j > left && array[j - 1] > value) {
+            array[j] = array[j - 1];
+            j--;
+        }
+        array[j] = value;
+    }
+}
+
 // Helper function: Serial Merge Sort (Base case or single thread)
 template <typename T>
-void merge_sort_serial(T *array, T *temp, size_t left, size_t right) {
-    if (left < right) {
+void merge_sort_serial(T *array, T *temp, size_t left, size_t right, const sort_config_t &config) {
+    if (right - left < config.leaf_cutoff) {
+        insertion_sort(array, left, right);
+    } else if (left < right) {
         size_t mid = left + (right - left) / 2;
-        merge_sort_serial(array, temp, left, mid);
-        merge_sort_serial(array, temp, mid + 1, right);
+        merge_sort_serial(array, temp, left, mid, config);
+        merge_sort_serial(array, temp, mid + 1, right, config);
         merge(array, temp, left, mid, right);
     }
 }
 
 // Helper function: Parallel Merge Sort using std::thread
 template <typename T>
-void merge_sort_parallel(T *array, T *temp, size_t left, size_t right, unsigned num_threads) {
+void merge_sort_parallel(T *array, T *temp, size_t left, size_t right, unsigned num_threads,
+                         const sort_config_t &config) {
     // Base case: If only 1 thread is available or range is small, use serial sort.
-    if (num_threads <= 1) {
-        merge_sort_serial(array, temp, left, right);
+    if (num_threads <= 1 || right - left + 1 < config.grain) {
+        merge_sort_serial(array, temp, left, right, config);
         return;
     }
 
@@ -73,11 +105,11 @@ void merge_sort_parallel(T *array, T *temp, size_t left, size_t right, unsigned
 
         // Create a thread for the left half
         std::thread t([=]() {
-            merge_sort_parallel(array, temp, left, mid, threads_left);
+            merge_sort_parallel(array, temp, left, mid, threads_left, config);
         });
 
         // Current thread handles the right half
-        merge_sort_parallel(array, temp, mid + 1, right, threads_right);
+        merge_sort_parallel(array, temp, mid + 1, right, threads_right, config);
 
         // Wait for the left thread to finish
         t.join();
@@ -89,21 +121,82 @@ void merge_sort_parallel(T *array, T *temp, size_t left, size_t right, unsigned
 
 // Main entry point
 template <typename T>
-void sort(T *array, const size_t num_data, const unsigned num_threads) {
+void sort(T *array, const size_t num_data, const unsigned num_threads,
+          const sort_config_t &config = sort_config_t()) {
     if (num_data <= 1) return;
 
     // 1. Allocate a temporary buffer ONCE to avoid overhead during recursion.
-    // Using new[] directly since we cannot use std::vector easily with pointer arithmetic 
+    // Using a raw buffer since we cannot use std::vector easily with pointer arithmetic 
     // in the recursive steps without passing iterators. 
-    // We manage memory manually for performance and simplicity in this context.
-    T *temp = new T[num_data];
+    // Large buffers are huge-page backed, and each thread first-touches the
+    // share of it that its merges will use.
+    T *temp = alloc_array<T>(num_data, num_threads);
 
     // 2. Start parallel merge sort.
     // range is [0, num_data - 1]
-    merge_sort_parallel(array, temp, 0, num_data - 1, num_threads);
+    merge_sort_parallel(array, temp, 0, num_data - 1, num_threads, config);
 
     // 3. Deallocate temporary buffer.
-    delete[] temp;
+    free_array(temp);
+}
+
+// Sort planner: estimate keeps the defaults, load takes the choice from
+// the wisdom file when it has one for this CPU model, size, and thread
+// count, and measure does the same but otherwise times the candidates on
+// a copy of up to 2^18 elements (leaf cutoff, then grain) and saves them.
+// Loaded values that are not among the candidates are ignored.
+template <typename T>
+sort_config_t tune_sort(const T *array, const size_t num_data, const unsigned num_threads,
+                        const wisdom_mode mode, const char *wisdom_file) {
+    sort_config_t config;
+    if (mode == wisdom_estimate) return config;
+
+    wisdom_t wisdom;
+    wisdom.load(wisdom_file);
+    std::ostringstream problem;
+    problem << "sort " << num_data << " threads=" << num_threads;
+    std::vector<long> values;
+    const size_t num_leaf = sizeof(leaf_candidates) / sizeof(size_t), num_grain = sizeof(grain_candidates) / sizeof(size_t);
+    if (wisdom.lookup(problem.str(), values) && values.size() == 2) {
+        if ((std::find(leaf_candidates, leaf_candidates + num_leaf, (size_t)values[0]) != leaf_candidates + num_leaf) &&
+            (std::find(grain_candidates, grain_candidates + num_grain, (size_t)values[1]) != grain_candidates + num_grain)) {
+            config.leaf_cutoff = values[0];
+            config.grain = values[1];
+            return config;
+        }
+        std::cerr << "Warning: ignoring invalid wisdom for " << problem.str() << " in " << wisdom_file << std::endl;
+    }
+    if (mode == wisdom_load) {
+        std::cerr << "Warning: no wisdom for " << problem.str() << " in " << wisdom_file
+                  << "; using estimates" << std::endl;
+        return config;
+    }
+
+    // Time each candidate on a fresh copy of the sample.
+    const size_t sample = std::min(num_data, (size_t)1 << 18);
+    std::vector<T> work(sample);
+    size_t *knobs[2] = { &config.leaf_cutoff, &config.grain };
+    const size_t *candidates[2] = { leaf_candidates, grain_candidates };
+    const size_t counts[2] = { num_leaf, num_grain };
+    for (int k = 0; k < 2; k++) {
+        double best = 0.0;
+        size_t choice = *knobs[k];
+        for (size_t i = 0; i < counts[k]; i++) {
+            *knobs[k] = candidates[k][i];
+            double elapsed = best_time([&]() {
+                std::copy(array, array + sample, work.begin());
+                sort(work.data(), sample, num_threads, config);
+            }, 3);
+            if (!i || elapsed < best) { best = elapsed; choice = *knobs[k]; }
+        }
+        *knobs[k] = choice;
+    }
+
+    wisdom.store(problem.str(), std::vector<long>{ (long)config.leaf_cutoff, (long)config.grain });
+    wisdom.save(wisdom_file);
+    std::cout << "Planner: leaf cutoff " << config.leaf_cutoff << ", grain " << config.grain
+              << " (saved to " << wisdom_file << ")" << std::endl;
+    return config;
 }
 
 #endif
\ No newline at end of file
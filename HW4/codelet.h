@@ -0,0 +1,118 @@
+/* codelet.h */
+#ifndef __CODELET_H__
+#define __CODELET_H__
+
+#include <complex>
+#include <utility>
+
+// Largest size with a straight-line codelet
+const unsigned FFT_CODELET_MAX = 64;
+
+// ---------------------------------------------------------------------
+// Helper: Compile-time Sine and Cosine
+// Taylor series, accurate to double precision for |x| <= pi, which
+// covers every twiddle angle -2*pi*k/n with k < n/2.
+// ---------------------------------------------------------------------
+constexpr double ct_sin(const double x) {
+    double term = x, sum = x;
+    for (int k = 1; k < 16; ++k) {
+        term *= -x * x / ((2 * k) * (2 * k + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double ct_cos(const double x) {
+    double term = 1, sum = 1;
+    for (int k = 1; k < 16; ++k) {
+        term *= -x * x / ((2 * k - 1) * (2 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+// Twiddle factors exp(-2*pi*i*k/N), k = 0 ... N/2-1, built at compile time
+template <unsigned N>
+struct codelet_twiddle_t {
+    constexpr codelet_twiddle_t() : re(), im() {
+        for (unsigned k = 0; k < N / 2; ++k) {
+            // Same angle as fft_plan_t, so both paths share the same twiddles.
+            const double theta = -2.0 * (double)3.141592653589793238460f * k / N;
+            re[k] = ct_cos(theta);
+            im[k] = ct_sin(theta);
+        }
+    }
+    double re[N / 2], im[N / 2];
+};
+
+// ---------------------------------------------------------------------
+// FFT Codelet
+// N-point DIT FFT of N bit-reversed inputs, unrolled at compile time:
+// two N/2-point codelets followed by N/2 butterflies whose twiddles are
+// constants. There are no loops, no twiddle loads, and w = 1 and w = -i
+// need no multiplication.
+// ---------------------------------------------------------------------
+template <unsigned N, typename T>
+struct fft_codelet {
+    template <bool inverse>
+    static void run(std::complex<T> *data) {
+        fft_codelet<N / 2, T>::template run<inverse>(data);
+        fft_codelet<N / 2, T>::template run<inverse>(data + N / 2);
+        combine<inverse>(data, std::make_index_sequence<N / 2>());
+    }
+
+private:
+    static constexpr codelet_twiddle_t<N> twiddle{};
+
+    template <bool inverse, size_t... X>
+    static inline void combine(std::complex<T> *data, std::index_sequence<X...>) {
+        (butterfly<inverse, X>(data), ...);
+    }
+
+    template <bool inverse, size_t X>
+    static inline void butterfly(std::complex<T> *data) {
+        const T ur = data[X].real(), ui = data[X].imag();
+        const T vr = data[X + N / 2].real(), vi = data[X + N / 2].imag();
+        T tr, ti;
+        if constexpr (X == 0) {                     // w = 1
+            tr = vr; ti = vi;
+        }
+        else if constexpr (4 * X == N) {            // w = -i (+i when inverse)
+            tr = inverse ? -vi : vi;
+            ti = inverse ? vr : -vr;
+        }
+        else {
+            constexpr T wr = T(twiddle.re[X]);
+            constexpr T wi = inverse ? T(-twiddle.im[X]) : T(twiddle.im[X]);
+            tr = wr * vr - wi * vi;
+            ti = wr * vi + wi * vr;
+        }
+        data[X] = std::complex<T>(ur + tr, ui + ti);
+        data[X + N / 2] = std::complex<T>(ur - tr, ui - ti);
+    }
+};
+
+template <typename T>
+struct fft_codelet<1, T> {
+    template <bool inverse>
+    static void run(std::complex<T> *) {}
+};
+
+// ---------------------------------------------------------------------
+// Helper: Codelet Lookup
+// Returns the codelet for a power-of-two size n <= FFT_CODELET_MAX.
+// ---------------------------------------------------------------------
+template <typename T>
+void (*codelet_for(const unsigned n, const bool inverse))(std::complex<T>*) {
+    switch (n) {
+        case 2:  return inverse ? fft_codelet<2, T>::template run<true>  : fft_codelet<2, T>::template run<false>;
+        case 4:  return inverse ? fft_codelet<4, T>::template run<true>  : fft_codelet<4, T>::template run<false>;
+        case 8:  return inverse ? fft_codelet<8, T>::template run<true>  : fft_codelet<8, T>::template run<false>;
+        case 16: return inverse ? fft_codelet<16, T>::template run<true> : fft_codelet<16, T>::template run<false>;
+        case 32: return inverse ? fft_codelet<32, T>::template run<true> : fft_codelet<32, T>::template run<false>;
+        case 64: return inverse ? fft_codelet<64, T>::template run<true> : fft_codelet<64, T>::template run<false>;
+        default: return fft_codelet<1, T>::template run<false>;
+    }
+}
+
+#endif
@@ -2,10 +2,81 @@
 #define __DATA_H__
 
 #include <algorithm>
+#include <charconv>
 #include <complex>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <mpi.h>
+#include <vector>
+#include "alloc.h"
+
+// Binary data file layout: a 32-byte header followed by raw row-major values.
+// complex64 values are interleaved (real, imaginary) float pairs.
+enum data_type { complex64 = 0, real32 };
+
+struct data_header_t {
+    char     magic[4];      // "FFTB"
+    uint32_t type;          // data_type of each value
+    uint32_t width;         // Number of columns
+    uint32_t height;        // Number of rows
+    uint32_t depth;         // Number of width x height planes
+    uint32_t reserved[3];   // Pads the header to 32 bytes
+};
+
+const char data_magic[4] = { 'F', 'F', 'T', 'B' };
+
+// Fill in a binary file header.
+inline data_header_t make_header(const uint32_t type, const unsigned width, const unsigned height,
+                                 const unsigned depth = 1) {
+    data_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, data_magic, sizeof(data_magic));
+    header.type = type;
+    header.width = width;
+    header.height = height;
+    header.depth = depth;
+    return header;
+}
+
+// Open a file on every rank of MPI_COMM_WORLD, aborting on failure.
+inline MPI_File open_file(const char *file_name, const int amode, const int rank_id) {
+    MPI_File fh;
+    if(MPI_File_open(MPI_COMM_WORLD, file_name, amode, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        if(!rank_id) { std::cerr << "Error: failed to open " << file_name << std::endl; }
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    return fh;
+}
+
+// Read the header of a complex64 binary file on every rank, aborting if
+// the file is not one.
+inline data_header_t read_header(MPI_File fh, const char *file_name, const int rank_id) {
+    data_header_t header;
+    memset(&header, 0, sizeof(header));
+    MPI_File_read_at_all(fh, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE);
+    if(memcmp(header.magic, data_magic, sizeof(data_magic)) || (header.type != complex64)) {
+        if(!rank_id) { std::cerr << "Error: " << file_name << " is not a complex64 binary file" << std::endl; }
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    return header;
+}
+
+// Value type stored in a binary file
+inline uint32_t type_of(const std::complex<float> *) { return complex64; }
+inline uint32_t type_of(const float *) { return real32; }
+
+// Split 'num_rows' rows across ranks. The first 'remainder' ranks take
+// one extra row so that uneven dimensions stay balanced.
+inline void partition(unsigned num_rows, int num_ranks, int rank_id,
+                      int &start_row, int &num_local_rows) {
+    int rows_per_rank = num_rows / num_ranks;
+    int remainder = num_rows % num_ranks;
+    start_row = rows_per_rank * rank_id + (rank_id < remainder ? rank_id : remainder);
+    num_local_rows = rows_per_rank + (rank_id < remainder ? 1 : 0);
+}
 
 // Read data from a file.
 template <typename T>
@@ -20,13 +91,110 @@ void read(const char *file_name, T *&data, unsigned &width, unsigned &height) {
     // Read the dimension information.
     fs >> width >> height;
     // Reserve vector space.
-    data = new T[width * height]();
+    data = alloc_array<T>(width * height);
     // Read input data.
     for_each(data, data + (width * height), [&fs](T &d) { fs >> d; });
     // Close the file.
     fs.close();
 }
 
+// Read real-valued data from a file.
+// Values may be given as plain reals or as complex pairs; imaginary parts are dropped.
+template <typename T>
+void read_real(const char *file_name, T *&data, unsigned &width, unsigned &height) {
+    // Open the file.
+    std::fstream fs;
+    fs.open(file_name, std::fstream::in);
+    if(!fs.is_open()) {
+        std::cerr << "Error: failed to open " << file_name << std::endl;
+        exit(1);
+    }
+    // Read the dimension information.
+    fs >> width >> height;
+    // Reserve vector space.
+    data = alloc_array<T>(width * height);
+    // Read input data, keeping the real parts only.
+    std::for_each(data, data + (width * height), [&fs](T &d) { std::complex<T> c; fs >> c; d = c.real(); });
+    // Close the file.
+    fs.close();
+}
+
+// Read data from a text file, dispatching on the element type.
+template <typename T>
+void read_text(const char *file_name, std::complex<T> *&data, unsigned &width, unsigned &height) {
+    read(file_name, data, width, height);
+}
+
+template <typename T>
+void read_text(const char *file_name, T *&data, unsigned &width, unsigned &height) {
+    read_real(file_name, data, width, height);
+}
+
+// Read data on every rank of MPI_COMM_WORLD.
+// A binary file is read with collective MPI-IO, and each rank loads only its
+// own row slab (see partition()); the other rows are left zero for the
+// transform to gather. Set 'slab_only' to false when every rank needs the
+// full matrix. A binary file must hold every plane its header declares,
+// and its dimensions must be powers of two unless 'any_size' is set for
+// inputs the caller pads itself. A text file is parsed once on rank 0 and
+// broadcast.
+template <typename T>
+void read(const char *file_name, T *&data, unsigned &width, unsigned &height,
+          const int num_ranks, const int rank_id, const bool slab_only = true,
+          const bool any_size = false) {
+    // Open the file and peek at the header.
+    MPI_File fh = open_file(file_name, MPI_MODE_RDONLY, rank_id);
+    data_header_t header;
+    memset(&header, 0, sizeof(header));
+    MPI_File_read_at_all(fh, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE);
+
+    // One contiguous MPI datatype per element
+    MPI_Datatype element;
+    MPI_Type_contiguous(sizeof(T), MPI_BYTE, &element);
+    MPI_Type_commit(&element);
+
+    if(!memcmp(header.magic, data_magic, sizeof(data_magic))) {
+        if((header.type != type_of(data)) || (header.depth < 1)) {
+            if(!rank_id) { std::cerr << "Error: unexpected data type in " << file_name << std::endl; }
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        if(!header.width || !header.height ||
+           (!any_size && ((header.width & (header.width - 1)) || (header.height & (header.height - 1))))) {
+            if(!rank_id) { std::cerr << "Error: unsupported dimensions " << header.width << "x" << header.height
+                                     << " in " << file_name << std::endl; }
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        MPI_Offset file_size = 0;
+        MPI_File_get_size(fh, &file_size);
+        if(file_size < (MPI_Offset)sizeof(data_header_t) +
+                       (MPI_Offset)header.width * header.height * header.depth * (MPI_Offset)sizeof(T)) {
+            if(!rank_id) { std::cerr << "Error: " << file_name << " is shorter than its header declares" << std::endl; }
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        width = header.width;
+        height = header.height;
+        data = alloc_array<T>(width * height);
+
+        // Read this rank's row slab of the first plane.
+        int my_start_row = 0, my_num_rows = height;
+        if(slab_only) { partition(height, num_ranks, rank_id, my_start_row, my_num_rows); }
+        MPI_Offset offset = sizeof(data_header_t) + (MPI_Offset)my_start_row * width * sizeof(T);
+        MPI_File_read_at_all(fh, offset, &data[my_start_row * width], my_num_rows * width,
+                             element, MPI_STATUS_IGNORE);
+        MPI_File_close(&fh);
+    }
+    else {
+        MPI_File_close(&fh);
+        // Text file: parse once and broadcast.
+        if(!rank_id) { read_text(file_name, data, width, height); }
+        MPI_Bcast(&width, 1, MPI_UNSIGNED, 0, MPI_COMM_WORLD);
+        MPI_Bcast(&height, 1, MPI_UNSIGNED, 0, MPI_COMM_WORLD);
+        if(rank_id) { data = alloc_array<T>(width * height); }
+        MPI_Bcast(data, width * height, element, 0, MPI_COMM_WORLD);
+    }
+    MPI_Type_free(&element);
+}
+
 // Write data into a file.
 template <typename T>
 void write(const char *file_name, T *data, const unsigned width, const unsigned height) {
@@ -50,9 +218,93 @@ void write(const char *file_name, T *data, const unsigned width, const unsigned
     fs.close();
 }
 
+// Append rows [start_row, start_row + num_rows) of a result to 'buffer'.
+// Text rows are formatted with std::to_chars exactly as write() prints
+// them, and 'dimensions' puts the "width height" line in front. Binary
+// rows are real32 magnitudes, and 'dimensions' puts a data_header_t in front.
+template <typename T>
+void format_rows(std::vector<char> &buffer, T *data, const unsigned width, const unsigned height,
+                 const unsigned start_row, const unsigned num_rows,
+                 const bool binary, const bool dimensions) {
+    size_t used = buffer.size();
+    if(binary) {
+        buffer.resize(used + (dimensions ? sizeof(data_header_t) : 0) + sizeof(float) * num_rows * width);
+        char *p = buffer.data() + used;
+        if(dimensions) {
+            data_header_t header = make_header(real32, width, height);
+            memcpy(p, &header, sizeof(header)); p += sizeof(header);
+        }
+        for(unsigned i = start_row * width; i < (start_row + num_rows) * width; i++) {
+            float magnitude = std::abs(data[i]);
+            memcpy(p, &magnitude, sizeof(float)); p += sizeof(float);
+        }
+    }
+    else {
+        // Longest fixed-point float with one decimal, plus a separator
+        const size_t max_field = 48;
+        // Write the dimension information.
+        if(dimensions) {
+            buffer.resize(used + max_field);
+            char *p = buffer.data() + used, *last = buffer.data() + buffer.size();
+            p = std::to_chars(p, last, width).ptr; *p++ = ' ';
+            p = std::to_chars(p, last, height).ptr; *p++ = '\n';
+            used = p - buffer.data();
+        }
+        // Write data, growing the buffer one row at a time.
+        buffer.reserve(used + (size_t)num_rows * width * 8);
+        for(unsigned r = start_row; r < start_row + num_rows; r++) {
+            buffer.resize(used + width * max_field + 1);
+            char *p = buffer.data() + used, *last = buffer.data() + buffer.size();
+            for(unsigned c = 0; c < width; c++) {
+                p = std::to_chars(p, last, std::abs(data[r * width + c]), std::chars_format::fixed, 1).ptr;
+                *p++ = ' ';
+            }   *p++ = '\n';
+            used = p - buffer.data();
+        }
+        buffer.resize(used);
+    }
+}
+
+// Write a result into a file in parallel on every rank of MPI_COMM_WORLD.
+// 'slab' holds only this rank's 'num_rows' rows (see partition()), which
+// the rank formats into a local buffer with std::to_chars. Each rank finds
+// its file offset with an exclusive prefix sum of the buffer sizes, and
+// all write with collective MPI-IO. The text output is byte-identical to
+// write(). With 'binary' set, the magnitudes are stored as real32 values
+// behind a data_header_t instead.
+template <typename T>
+void write_slab(const char *file_name, T *slab, const unsigned width, const unsigned height,
+                const unsigned num_rows, const int rank_id, const bool binary = false) {
+    // Format this rank's slab.
+    std::vector<char> buffer;
+    format_rows(buffer, slab, width, height, 0, num_rows, binary, !rank_id);
+
+    // File offset of this rank's slab
+    long long my_size = buffer.size(), my_offset = 0;
+    MPI_Exscan(&my_size, &my_offset, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    if(!rank_id) { my_offset = 0; }
+
+    // Write all slabs with collective MPI-IO.
+    MPI_File fh = open_file(file_name, MPI_MODE_CREATE|MPI_MODE_WRONLY, rank_id);
+    MPI_File_set_size(fh, 0);
+    MPI_File_write_at_all(fh, my_offset, buffer.data(), buffer.size(), MPI_CHAR, MPI_STATUS_IGNORE);
+    MPI_File_close(&fh);
+}
+
+// Write data into a file in parallel on every rank of MPI_COMM_WORLD.
+// 'data' holds the full matrix, and each rank writes its own row slab
+// with write_slab().
+template <typename T>
+void write(const char *file_name, T *data, const unsigned width, const unsigned height,
+           const int num_ranks, const int rank_id, const bool binary = false) {
+    int my_start_row = 0, my_num_rows = 0;
+    partition(height, num_ranks, rank_id, my_start_row, my_num_rows);
+    write_slab(file_name, &data[my_start_row * width], width, height, my_num_rows, rank_id, binary);
+}
+
 // Deallocate the data array.
 template <typename T>
-void fin(T *data) { delete [] data; }
+void fin(T *data) { free_array(data); }
 
 #endif
 
@@ -10,41 +10,105 @@
 #include <cmath>
 #include <algorithm>
 #include "abort.h"
+#include "codelet.h"
+#include "prof.h"
+#include "wire.h"
 #include "data.h"
 
 // Constant for PI
 const float PI = 3.141592653589793238460;
 
+// Transform direction
+enum fft_direction { fft_forward = 0, fft_inverse };
+
+// ---------------------------------------------------------------------
+// Tuning Parameters
+// Host-dependent choices shared by all transforms. The defaults are the
+// planner's estimates; plan_fft() replaces them with measured values.
+// ---------------------------------------------------------------------
+struct fft_tuning_t {
+    unsigned codelet_max;   // Largest codelet used by new plans (power of two)
+    unsigned tile;          // Transpose tile edge (0: untiled)
+    unsigned batch;         // Frames per batch in streaming mode
+};
+inline fft_tuning_t fft_tuning = { FFT_CODELET_MAX, 32, 4 };
+
+// ---------------------------------------------------------------------
+// FFT Plan
+// Precomputes the bit-reversal permutation and the twiddle factors
+// exp(-2*pi*i*k/n), k = 0 ... n/2-1, for one power-of-two size n.
+// Every stage and both directions index into the same table, so a plan
+// is built once per transform size and reused for all rows.
+// The first log2(codelet_size) stages run as straight-line codelets on
+// consecutive blocks; sizes up to FFT_CODELET_MAX are entirely codelets.
+// ---------------------------------------------------------------------
+template <typename T>
+struct fft_plan_t {
+    explicit fft_plan_t(unsigned m_n) : n(m_n), rev(m_n), twiddle(m_n / 2),
+                                        codelet_size(std::min(m_n, fft_tuning.codelet_max)) {
+        codelet[fft_forward] = codelet_for<T>(codelet_size, false);
+        codelet[fft_inverse] = codelet_for<T>(codelet_size, true);
+
+        // Bit-reversal permutation
+        for (unsigned i = 0, j = 0; i < n; ++i) {
+            rev[i] = j;
+            unsigned m = n >> 1;
+            while (m >= 1 && j & m) {
+                j ^= m;
+                m >>= 1;
+            }
+            j ^= m;
+        }
+        // Twiddle factors, computed directly rather than by recurrence
+        for (unsigned k = 0; k < n / 2; ++k) {
+            double theta = -2.0 * PI * k / n;
+            twiddle[k] = std::complex<T>(std::cos(theta), std::sin(theta));
+        }
+    }
+
+    unsigned n;                             // Transform size
+    std::vector<unsigned> rev;              // Bit-reversal permutation
+    std::vector<std::complex<T> > twiddle;  // exp(-2*pi*i*k/n)
+    unsigned codelet_size;                  // Block size of the codelet stages
+    void (*codelet[2])(std::complex<T>*);   // Codelets by fft_direction
+};
+
 // ---------------------------------------------------------------------
 // Helper: Perform Bit-Reversal Permutation and Iterative FFT
 // Implements Cooley-Tukey Algorithm (O(N log N))
+// The inverse transform conjugates the twiddles and scales by 1/n.
 // ---------------------------------------------------------------------
 template <typename T>
-void fft_1d_iterative(std::complex<T>* data, int n) {
+void fft_1d_iterative(std::complex<T>* data, const fft_plan_t<T>& plan,
+                      const fft_direction dir = fft_forward) {
+    const int n = plan.n;
+
     // 1. Bit-Reversal Permutation
-    int j = 0;
     for (int i = 0; i < n; ++i) {
+        int j = plan.rev[i];
         if (i < j) {
             std::swap(data[i], data[j]);
         }
-        int m = n >> 1;
-        while (m >= 1 && j & m) {
-            j ^= m;
-            m >>= 1;
-        }
-        j ^= m;
     }
 
-    // 2. Iterative FFT (Danielson-Lanczos Lemma)
-    // m: size of the current sub-DFT (2, 4, 8, ... n)
-    for (int m = 2; m <= n; m <<= 1) {
-        T theta = -2.0 * PI / m;
-        std::complex<T> w_m(std::cos(theta), std::sin(theta)); // Complex weight base
-        
+    // 2. Codelets run the first stages, whose sub-DFTs stay within
+    //    blocks of codelet_size consecutive elements.
+    const int block = plan.codelet_size;
+    for (int k = 0; k < n; k += block) {
+        plan.codelet[dir](&data[k]);
+    }
+
+    // 3. Iterative FFT (Danielson-Lanczos Lemma) for the remaining stages
+    // m: size of the current sub-DFT (2 * block, ... n)
+    for (int m = 2 * block; m <= n; m <<= 1) {
+        const int stride = n / m; // Twiddle stride: w_m^x = w_n^(x * n/m)
+
         // Process each block of size m
         for (int k = 0; k < n; k += m) {
-            std::complex<T> w(1.0, 0.0); // w starts at 1
             for (int x = 0; x < m / 2; ++x) {
+                std::complex<T> w = plan.twiddle[x * stride];
+                if (dir == fft_inverse) { w = std::conj(w); }
+
                 // Butterfly Operation
                 // u = Even part, t = w * Odd part
                 std::complex<T> t = w * data[k + x + m / 2];
@@ -52,59 +116,153 @@ void fft_1d_iterative(std::complex<T>* data, int n) {
 
                 data[k + x] = u + t;
                 data[k + x + m / 2] = u - t;
-
-                w *= w_m; // Update weight
             }
         }
     }
+
+    // 4. Normalize the inverse transform.
+    if (dir == fft_inverse) {
+        const T scale = T(1) / n;
+        for (int i = 0; i < n; ++i) { data[i] *= scale; }
+    }
+}
+
+// ---------------------------------------------------------------------
+// Helper: Real-to-Complex 1D FFT (Half-Length Trick)
+// Packs n real samples into n/2 complex values z[k] = x[2k] + i*x[2k+1],
+// runs an n/2-point complex FFT, and splits the result into the n/2+1
+// non-redundant bins of the real signal's spectrum.
+// 'half_plan' is the n/2-point plan, and 'w' holds the split twiddles
+// exp(-2*pi*i*k/n) for k = 0 ... n/2.
+// ---------------------------------------------------------------------
+template <typename T>
+void fft_1d_r2c(const T* in, std::complex<T>* out, int n,
+                const fft_plan_t<T>& half_plan, const std::complex<T>* w) {
+    if (n < 2) { out[0] = std::complex<T>(in[0], 0); return; }
+    int h = n / 2;
+
+    // 1. Pack even/odd samples as real/imaginary parts and transform.
+    for (int k = 0; k < h; ++k) {
+        out[k] = std::complex<T>(in[2 * k], in[2 * k + 1]);
+    }
+    fft_1d_iterative(out, half_plan);
+
+    // 2. Split: X[k] = E[k] + w^k * O[k], where
+    //    E[k] = (Z[k] + conj(Z[h-k])) / 2 and O[k] = (Z[k] - conj(Z[h-k])) / 2i.
+    //    Bins k and h-k depend on the same pair, so they are produced together.
+    std::complex<T> z0 = out[0];
+    out[0] = std::complex<T>(z0.real() + z0.imag(), 0);
+    out[h] = std::complex<T>(z0.real() - z0.imag(), 0);
+
+    const std::complex<T> half_i(0, 0.5);
+    for (int k = 1; k <= h / 2; ++k) {
+        std::complex<T> a = out[k];
+        std::complex<T> b = out[h - k];
+        out[k]     = T(0.5) * (a + std::conj(b)) - half_i * w[k]     * (a - std::conj(b));
+        out[h - k] = T(0.5) * (b + std::conj(a)) - half_i * w[h - k] * (b - std::conj(a));
+    }
+}
+
+// ---------------------------------------------------------------------
+// Helper: Complex-to-Real 1D Inverse FFT (Half-Length Trick)
+// Inverse of fft_1d_r2c(). Reads the n/2+1 bins of a real signal's
+// spectrum from 'data', merges them into the n/2-point spectrum of
+// z[k] = x[2k] + i*x[2k+1], and runs an n/2-point inverse FFT in place.
+// On return data[k] holds the samples x[2k] and x[2k+1] as its real and
+// imaginary parts, scaled by 1/n. 'half_plan' and 'w' are as in r2c.
+// ---------------------------------------------------------------------
+template <typename T>
+void fft_1d_c2r(std::complex<T>* data, int n,
+                const fft_plan_t<T>& half_plan, const std::complex<T>* w) {
+    if (n < 2) { return; }
+    int h = n / 2;
+
+    // 1. Merge: Z[k] = E[k] + i * O[k], where
+    //    E[k] = (X[k] + conj(X[h-k])) / 2 and O[k] = (X[k] - conj(X[h-k])) / (2 * w^k).
+    //    Bins k and h-k are merged together, as in the r2c split.
+    const std::complex<T> half_i(0, 0.5);
+    std::complex<T> x0 = data[0], xh = std::conj(data[h]);
+    data[0] = T(0.5) * (x0 + xh) + half_i * (x0 - xh);
+
+    for (int k = 1; k <= h / 2; ++k) {
+        std::complex<T> a = data[k];
+        std::complex<T> b = data[h - k];
+        data[k]     = T(0.5) * (a + std::conj(b)) + half_i * std::conj(w[k])     * (a - std::conj(b));
+        data[h - k] = T(0.5) * (b + std::conj(a)) + half_i * std::conj(w[h - k]) * (b - std::conj(a));
+    }
+
+    // 2. Inverse transform back to the packed even/odd samples.
+    fft_1d_iterative(data, half_plan, fft_inverse);
 }
 
 // ---------------------------------------------------------------------
 // Helper: Matrix Transpose
 // Transposes the matrix held in 'data' (width x height).
 // Since we sync data globally, everyone holds the full matrix to transpose.
+// Works in fft_tuning.tile square tiles so that both the rows read and
+// the rows written stay in cache.
 // ---------------------------------------------------------------------
 template <typename T>
 void transpose(std::complex<T>* data, unsigned width, unsigned height) {
-    std::complex<T>* temp = new std::complex<T>[width * height];
+    std::complex<T>* temp = alloc_array<std::complex<T> >(width * height);
+    const unsigned tile = fft_tuning.tile ? fft_tuning.tile : std::max(width, height);
 
-    for (unsigned y = 0; y < height; ++y) {
-        for (unsigned x = 0; x < width; ++x) {
-            // temp[row][col] = data[col][row]
-            // Input is row-major: index = y * width + x
-            // Transposed index: x * height + y
-            temp[x * height + y] = data[y * width + x];
+    for (unsigned y0 = 0; y0 < height; y0 += tile) {
+        for (unsigned x0 = 0; x0 < width; x0 += tile) {
+            for (unsigned y = y0; y < std::min(y0 + tile, height); ++y) {
+                for (unsigned x = x0; x < std::min(x0 + tile, width); ++x) {
+                    // temp[row][col] = data[col][row]
+                    // Input is row-major: index = y * width + x
+                    // Transposed index: x * height + y
+                    temp[x * height + y] = data[y * width + x];
+                }
+            }
         }
     }
 
     std::memcpy(data, temp, sizeof(std::complex<T>) * width * height);
-    delete[] temp;
+    free_array(temp);
 }
 
 // ---------------------------------------------------------------------
 // Helper: Custom Allgather using MPI_Irecv and MPI_Send
 // Synchronizes partial results from all ranks to construct the full matrix.
+// With 'frames' > 1, 'data' holds that many width x height matrices back to
+// back, and each rank's slab of every frame travels in a single message
+// described by a strided datatype, so a batch costs one message per peer.
+// Reduced fft_wire formats go through collect_packed() instead.
 // ---------------------------------------------------------------------
 template <typename T>
 void collect_results(std::complex<T>* data, unsigned width, unsigned height, 
                      int num_ranks, int my_rank, 
-                     int my_start_row, int my_num_rows) {
+                     int my_start_row, int my_num_rows, unsigned frames = 1) {
+    if (fft_wire != wire_fp32) {
+        collect_packed(data, width, height, num_ranks, my_rank, my_start_row, my_num_rows, frames);
+        return;
+    }
     
     std::vector<MPI_Request> requests(num_ranks);
+    std::vector<MPI_Datatype> slabs(num_ranks, MPI_COMPLEX);
+    const int frame_size = width * height;
     
     // Calculate layout for all ranks to determine offsets
-    int rows_per_rank = height / num_ranks;
-    int remainder = height % num_ranks;
     int current_offset = 0;
 
     // 1. Post Non-blocking Receives (Irecv)
     for (int r = 0; r < num_ranks; ++r) {
-        int r_rows = rows_per_rank + (r < remainder ? 1 : 0);
+        int r_start = 0, r_rows = 0;
+        partition(height, num_ranks, r, r_start, r_rows);
         int r_count = r_rows * width;
 
+        // One slab per frame, 'frame_size' elements apart
+        if (frames > 1) {
+            MPI_Type_vector(frames, r_count, frame_size, MPI_COMPLEX, &slabs[r]);
+            MPI_Type_commit(&slabs[r]);
+        }
+
         // Receive chunk from rank 'r'
         // Note: MPI_COMPLEX matches std::complex<float> layout
-        MPI_Irecv(&data[current_offset], r_count, MPI_COMPLEX, r, 0, MPI_COMM_WORLD, &requests[r]);
+        MPI_Irecv(&data[current_offset], frames > 1 ? 1 : r_count, slabs[r], r, 0, MPI_COMM_WORLD, &requests[r]);
         
         current_offset += r_count;
     }
@@ -114,47 +272,61 @@ void collect_results(std::complex<T>* data, unsigned width, unsigned height,
     int my_offset_idx = my_start_row * width;
 
     for (int r = 0; r < num_ranks; ++r) {
-        MPI_Send(&data[my_offset_idx], my_data_count, MPI_COMPLEX, r, 0, MPI_COMM_WORLD);
+        MPI_Send(&data[my_offset_idx], frames > 1 ? 1 : my_data_count, slabs[my_rank], r, 0, MPI_COMM_WORLD);
     }
 
     // 3. Wait for completion
     MPI_Waitall(num_ranks, requests.data(), MPI_STATUSES_IGNORE);
+
+    if (frames > 1) {
+        for (int r = 0; r < num_ranks; ++r) { MPI_Type_free(&slabs[r]); }
+    }
 }
 
 // ---------------------------------------------------------------------
-// Main Function: 2-D Discrete Fourier Transform
+// Phase 1: Rows -> Transpose -> Columns
+// Runs the row-wise 1D DFT (Step a), gathers and transposes (Step b),
+// and runs the row-wise 1D DFT on the transposed matrix (Step c).
+// On return 'data' is in the transposed width x height layout, and only
+// this rank's slab of transposed rows holds the finished values.
+// 'frames' matrices stored back to back are transformed as one batch.
 // ---------------------------------------------------------------------
 template <typename T>
-void dft2d(std::complex<T> *data, const unsigned width, const unsigned height,
-           const int num_ranks, const int rank_id) {
-    
+void dft2d_to_transposed(std::complex<T> *data, const unsigned width, const unsigned height,
+                         const fft_plan_t<T> &row_plan, const fft_plan_t<T> &col_plan,
+                         const fft_direction dir, const int num_ranks, const int rank_id,
+                         const unsigned frames = 1) {
+    const unsigned frame_size = width * height;
+
     // --- 1. Load Balancing Calculation ---
     // Determine which rows this rank is responsible for.
-    int rows_per_rank = height / num_ranks;
-    int remainder = height % num_ranks;
-    
-    // Calculate start row index
-    int my_start_row = rows_per_rank * rank_id + (rank_id < remainder ? rank_id : remainder);
-    // Calculate number of rows to process
-    int my_num_rows = rows_per_rank + (rank_id < remainder ? 1 : 0);
+    int my_start_row = 0, my_num_rows = 0;
+    partition(height, num_ranks, rank_id, my_start_row, my_num_rows);
 
     // --- Step a: Row-wise 1D DFT ---
-    for (int r = 0; r < my_num_rows; ++r) {
-        int global_row_idx = my_start_row + r;
-        // Pointer to the start of the current row
-        std::complex<T>* row_ptr = &data[global_row_idx * width];
-        
-        // Perform FFT on this row in-place
-        fft_1d_iterative(row_ptr, width);
+    mark_phase(phase_row_fft);
+    for (unsigned f = 0; f < frames; ++f) {
+        for (int r = 0; r < my_num_rows; ++r) {
+            int global_row_idx = my_start_row + r;
+            // Pointer to the start of the current row
+            std::complex<T>* row_ptr = &data[f * frame_size + global_row_idx * width];
+            
+            // Perform FFT on this row in-place
+            fft_1d_iterative(row_ptr, row_plan, dir);
+        }
     }
 
     // Sync: Gather all row-wise results
-    collect_results(data, width, height, num_ranks, rank_id, my_start_row, my_num_rows);
+    mark_phase(phase_row_gather);
+    collect_results(data, width, height, num_ranks, rank_id, my_start_row, my_num_rows, frames);
 
     // --- Step b: Transpose ---
     // Now everyone has the full Row-FFT matrix. Transpose it.
     // After transpose, 'width' becomes 'height' logically, but buffer size is same.
-    transpose(data, width, height);
+    mark_phase(phase_transpose);
+    for (unsigned f = 0; f < frames; ++f) {
+        transpose(&data[f * frame_size], width, height);
+    }
 
     // --- Step c: Row-wise 1D DFT (on Transposed Matrix) ---
     // Since we transposed, we are now technically processing columns of the original matrix.
@@ -163,23 +335,355 @@ void dft2d(std::complex<T> *data, const unsigned width, const unsigned height,
     int t_height = width;
 
     // Recalculate load balancing for the transposed dimensions
-    rows_per_rank = t_height / num_ranks;
-    remainder = t_height % num_ranks;
-    my_start_row = rows_per_rank * rank_id + (rank_id < remainder ? rank_id : remainder);
-    my_num_rows = rows_per_rank + (rank_id < remainder ? 1 : 0);
+    partition(t_height, num_ranks, rank_id, my_start_row, my_num_rows);
+    mark_phase(phase_col_fft);
+
+    for (unsigned f = 0; f < frames; ++f) {
+        for (int r = 0; r < my_num_rows; ++r) {
+            int global_row_idx = my_start_row + r;
+            std::complex<T>* row_ptr = &data[f * frame_size + global_row_idx * t_width];
+            
+            fft_1d_iterative(row_ptr, col_plan, dir);
+        }
+    }
+    mark_phase(phase_other);
+}
+
+// ---------------------------------------------------------------------
+// Phase 2: Columns -> Transpose Back -> Rows
+// Mirror image of dft2d_to_transposed(). Starts from the transposed
+// width x height layout where only this rank's slab is valid, runs the
+// column DFT on that slab, transposes back, and runs the row DFT.
+// On return every rank holds the full height x width result.
+// ---------------------------------------------------------------------
+template <typename T>
+void dft2d_from_transposed(std::complex<T> *data, const unsigned width, const unsigned height,
+                           const fft_plan_t<T> &row_plan, const fft_plan_t<T> &col_plan,
+                           const fft_direction dir, const int num_ranks, const int rank_id) {
+    int my_start_row = 0, my_num_rows = 0;
 
+    // --- Column-wise 1D DFT on this rank's transposed slab ---
+    partition(width, num_ranks, rank_id, my_start_row, my_num_rows);
+
+    mark_phase(phase_col_fft);
     for (int r = 0; r < my_num_rows; ++r) {
-        int global_row_idx = my_start_row + r;
-        std::complex<T>* row_ptr = &data[global_row_idx * t_width];
-        
-        fft_1d_iterative(row_ptr, t_width);
+        fft_1d_iterative(&data[(my_start_row + r) * height], col_plan, dir);
+    }
+
+    mark_phase(phase_col_gather);
+    collect_results(data, height, width, num_ranks, rank_id, my_start_row, my_num_rows);
+
+    // --- Transpose back to height x width ---
+    mark_phase(phase_transpose);
+    transpose(data, height, width);
+
+    // --- Row-wise 1D DFT ---
+    partition(height, num_ranks, rank_id, my_start_row, my_num_rows);
+
+    mark_phase(phase_row_fft);
+    for (int r = 0; r < my_num_rows; ++r) {
+        fft_1d_iterative(&data[(my_start_row + r) * width], row_plan, dir);
     }
 
+    mark_phase(phase_row_gather);
+    collect_results(data, width, height, num_ranks, rank_id, my_start_row, my_num_rows);
+    mark_phase(phase_other);
+}
+
+// ---------------------------------------------------------------------
+// Helper: Finish a transform left in the transposed layout
+// Gathers the transposed slabs and transposes back (Step d).
+// ---------------------------------------------------------------------
+template <typename T>
+void dft2d_transpose_back(std::complex<T> *data, const unsigned width, const unsigned height,
+                          const int num_ranks, const int rank_id, const unsigned frames = 1) {
+    int my_start_row = 0, my_num_rows = 0;
+    partition(width, num_ranks, rank_id, my_start_row, my_num_rows);
+
     // Sync: Gather all results again
-    collect_results(data, t_width, t_height, num_ranks, rank_id, my_start_row, my_num_rows);
+    mark_phase(phase_col_gather);
+    collect_results(data, height, width, num_ranks, rank_id, my_start_row, my_num_rows, frames);
+
+    // --- Step d: Transpose Back ---
+    mark_phase(phase_transpose);
+    for (unsigned f = 0; f < frames; ++f) {
+        transpose(&data[f * width * height], height, width);
+    }
+    mark_phase(phase_other);
+}
+
+// ---------------------------------------------------------------------
+// Main Function: 2-D Discrete Fourier Transform
+// ---------------------------------------------------------------------
+template <typename T>
+void dft2d(std::complex<T> *data, const unsigned width, const unsigned height,
+           const int num_ranks, const int rank_id) {
+    fft_plan_t<T> row_plan(width), col_plan(height);
+
+    dft2d_to_transposed(data, width, height, row_plan, col_plan, fft_forward, num_ranks, rank_id);
+    dft2d_transpose_back(data, width, height, num_ranks, rank_id);
+}
+
+// ---------------------------------------------------------------------
+// Inverse 2-D Discrete Fourier Transform
+// Same plans, twiddle tables, and distributed layout as dft2d(), with
+// conjugated twiddles and a 1/(width*height) normalization.
+// ---------------------------------------------------------------------
+template <typename T>
+void idft2d(std::complex<T> *data, const unsigned width, const unsigned height,
+            const int num_ranks, const int rank_id) {
+    fft_plan_t<T> row_plan(width), col_plan(height);
+
+    dft2d_to_transposed(data, width, height, row_plan, col_plan, fft_inverse, num_ranks, rank_id);
+    dft2d_transpose_back(data, width, height, num_ranks, rank_id);
+}
+
+// ---------------------------------------------------------------------
+// FFT-based 2-D Linear Convolution
+// Zero-pads both inputs to a power-of-two size that holds the full
+// (width + k_width - 1) x (height + k_height - 1) result, transforms both,
+// and multiplies the spectra while they are still in the transposed
+// distributed layout. The inverse transform then starts from that layout,
+// so the transpose back and the re-transpose of a separate
+// dft2d() / idft2d() pair are skipped.
+// Both inputs must be complete on every rank.
+// 'result' is allocated here and released by the caller with fin().
+// ---------------------------------------------------------------------
+template <typename T>
+void convolve2d(const std::complex<T> *image, const unsigned width, const unsigned height,
+                const std::complex<T> *kernel, const unsigned k_width, const unsigned k_height,
+                std::complex<T> *&result, unsigned &r_width, unsigned &r_height,
+                const int num_ranks, const int rank_id) {
+    r_width = width + k_width - 1;
+    r_height = height + k_height - 1;
+
+    // Power-of-two padded dimensions
+    unsigned p_width = 1, p_height = 1;
+    while (p_width < r_width) { p_width <<= 1; }
+    while (p_height < r_height) { p_height <<= 1; }
+
+    // Zero-padded copies of both inputs
+    std::complex<T> *a = alloc_array<std::complex<T> >(p_width * p_height);
+    std::complex<T> *b = alloc_array<std::complex<T> >(p_width * p_height);
+    for (unsigned y = 0; y < height; ++y) {
+        std::copy(&image[y * width], &image[(y + 1) * width], &a[y * p_width]);
+    }
+    for (unsigned y = 0; y < k_height; ++y) {
+        std::copy(&kernel[y * k_width], &kernel[(y + 1) * k_width], &b[y * p_width]);
+    }
+
+    fft_plan_t<T> row_plan(p_width), col_plan(p_height);
+
+    // Forward transforms, stopping in the transposed layout
+    dft2d_to_transposed(a, p_width, p_height, row_plan, col_plan, fft_forward, num_ranks, rank_id);
+    dft2d_to_transposed(b, p_width, p_height, row_plan, col_plan, fft_forward, num_ranks, rank_id);
+
+    // Pointwise multiply on this rank's transposed slab only
+    int my_start_row = 0, my_num_rows = 0;
+    partition(p_width, num_ranks, rank_id, my_start_row, my_num_rows);
+    for (unsigned i = my_start_row * p_height; i < (my_start_row + my_num_rows) * p_height; ++i) {
+        a[i] *= b[i];
+    }
+    free_array(b);
+
+    // Inverse transform from the transposed layout
+    dft2d_from_transposed(a, p_width, p_height, row_plan, col_plan, fft_inverse, num_ranks, rank_id);
+
+    // Crop the linear convolution out of the padded buffer.
+    result = alloc_array<std::complex<T> >(r_width * r_height);
+    for (unsigned y = 0; y < r_height; ++y) {
+        std::copy(&a[y * p_width], &a[y * p_width + r_width], &result[y * r_width]);
+    }
+    free_array(a);
+}
+
+// ---------------------------------------------------------------------
+// Real-to-Complex 2-D Discrete Fourier Transform
+// The spectrum of a real image is Hermitian, X[r][c] = conj(X[-r][-c]),
+// so only the width/2+1 leftmost columns are computed, stored, and
+// exchanged between ranks. 'half' must hold height x (width/2+1) values.
+// ---------------------------------------------------------------------
+template <typename T>
+void dft2d_r2c(const T *data, std::complex<T> *half, const unsigned width, const unsigned height,
+               const int num_ranks, const int rank_id) {
+    const unsigned h_width = width / 2 + 1;
+    fft_plan_t<T> half_plan(width > 1 ? width / 2 : 1), col_plan(height);
+
+    // Split twiddles shared by every row: exp(-2*pi*i*k/width).
+    std::vector<std::complex<T> > w(h_width);
+    for (unsigned k = 0; k < h_width; ++k) {
+        double theta = -2.0 * PI * k / width;
+        w[k] = std::complex<T>(std::cos(theta), std::sin(theta));
+    }
+
+    // --- Step a: Row-wise real-to-complex 1D DFT ---
+    int my_start_row = 0, my_num_rows = 0;
+    partition(height, num_ranks, rank_id, my_start_row, my_num_rows);
+
+    for (int r = 0; r < my_num_rows; ++r) {
+        int global_row_idx = my_start_row + r;
+        fft_1d_r2c(&data[global_row_idx * width], &half[global_row_idx * h_width], width,
+                   half_plan, w.data());
+    }
+
+    // Sync: Gather the half-width rows only.
+    collect_results(half, h_width, height, num_ranks, rank_id, my_start_row, my_num_rows);
+
+    // --- Step b: Transpose (height x h_width -> h_width x height) ---
+    transpose(half, h_width, height);
+
+    // --- Step c: Complex 1D DFT over the h_width remaining columns ---
+    partition(h_width, num_ranks, rank_id, my_start_row, my_num_rows);
+
+    for (int r = 0; r < my_num_rows; ++r) {
+        int global_row_idx = my_start_row + r;
+        fft_1d_iterative(&half[global_row_idx * height], col_plan);
+    }
+
+    collect_results(half, height, h_width, num_ranks, rank_id, my_start_row, my_num_rows);
 
     // --- Step d: Transpose Back ---
-    transpose(data, t_width, t_height);
+    transpose(half, height, h_width);
+}
+
+// ---------------------------------------------------------------------
+// Complex-to-Real Inverse 2-D Discrete Fourier Transform
+// Inverse of dft2d_r2c(). Reads the height x (width/2+1) half spectrum,
+// complete on every rank, with the same layout and partitioning: the
+// width/2+1 columns are inverse transformed and exchanged, and each rank
+// then turns its slab of rows back into real samples with fft_1d_c2r().
+// The packed rows are gathered in the half-spectrum layout, so 'half' is
+// overwritten. On return every rank holds the full width x height 'data'.
+// ---------------------------------------------------------------------
+template <typename T>
+void idft2d_c2r(std::complex<T> *half, T *data, const unsigned width, const unsigned height,
+                const int num_ranks, const int rank_id) {
+    const unsigned h_width = width / 2 + 1;
+    fft_plan_t<T> half_plan(width > 1 ? width / 2 : 1), col_plan(height);
+
+    // Split twiddles shared by every row: exp(-2*pi*i*k/width).
+    std::vector<std::complex<T> > w(h_width);
+    for (unsigned k = 0; k < h_width; ++k) {
+        double theta = -2.0 * PI * k / width;
+        w[k] = std::complex<T>(std::cos(theta), std::sin(theta));
+    }
+
+    // --- Step a: Transpose (height x h_width -> h_width x height) ---
+    transpose(half, h_width, height);
+
+    // --- Step b: Complex inverse 1D DFT over the h_width columns ---
+    int my_start_row = 0, my_num_rows = 0;
+    partition(h_width, num_ranks, rank_id, my_start_row, my_num_rows);
+
+    for (int r = 0; r < my_num_rows; ++r) {
+        int global_row_idx = my_start_row + r;
+        fft_1d_iterative(&half[global_row_idx * height], col_plan, fft_inverse);
+    }
+
+    collect_results(half, height, h_width, num_ranks, rank_id, my_start_row, my_num_rows);
+
+    // --- Step c: Transpose Back ---
+    transpose(half, height, h_width);
+
+    // --- Step d: Row-wise complex-to-real 1D DFT, packed in place ---
+    partition(height, num_ranks, rank_id, my_start_row, my_num_rows);
+
+    for (int r = 0; r < my_num_rows; ++r) {
+        int global_row_idx = my_start_row + r;
+        fft_1d_c2r(&half[global_row_idx * h_width], width, half_plan, w.data());
+    }
+
+    // Sync: Gather the packed rows, then unpack the even/odd samples.
+    collect_results(half, h_width, height, num_ranks, rank_id, my_start_row, my_num_rows);
+
+    for (unsigned r = 0; r < height; ++r) {
+        for (unsigned c = 0; c < width; ++c) {
+            const std::complex<T> &z = half[r * h_width + c / 2];
+            data[r * width + c] = (c & 1) ? z.imag() : z.real();
+        }
+    }
+}
+
+// ---------------------------------------------------------------------
+// FFT-based 2-D Linear Convolution of Real Inputs
+// Same padding and cropping as convolve2d(), but both inputs are real, so
+// each goes through dft2d_r2c() and the product of the half spectra
+// comes back through idft2d_c2r(). Every transform, buffer, and exchange
+// covers only width/2+1 columns.
+// Both inputs must be complete on every rank.
+// 'result' is allocated here and released by the caller with fin().
+// ---------------------------------------------------------------------
+template <typename T>
+void convolve2d_r2c(const T *image, const unsigned width, const unsigned height,
+                    const T *kernel, const unsigned k_width, const unsigned k_height,
+                    T *&result, unsigned &r_width, unsigned &r_height,
+                    const int num_ranks, const int rank_id) {
+    r_width = width + k_width - 1;
+    r_height = height + k_height - 1;
+
+    // Power-of-two padded dimensions
+    unsigned p_width = 1, p_height = 1;
+    while (p_width < r_width) { p_width <<= 1; }
+    while (p_height < r_height) { p_height <<= 1; }
+    const unsigned h_width = p_width / 2 + 1;
+
+    // Zero-padded copy of one input at a time, and the half spectra
+    T *padded = alloc_array<T>(p_width * p_height);
+    std::complex<T> *a = alloc_array<std::complex<T> >(h_width * p_height);
+    std::complex<T> *b = alloc_array<std::complex<T> >(h_width * p_height);
+    for (unsigned y = 0; y < height; ++y) {
+        std::copy(&image[y * width], &image[(y + 1) * width], &padded[y * p_width]);
+    }
+    dft2d_r2c(padded, a, p_width, p_height, num_ranks, rank_id);
+
+    std::fill(padded, padded + p_width * p_height, T(0));
+    for (unsigned y = 0; y < k_height; ++y) {
+        std::copy(&kernel[y * k_width], &kernel[(y + 1) * k_width], &padded[y * p_width]);
+    }
+    dft2d_r2c(padded, b, p_width, p_height, num_ranks, rank_id);
+
+    // Pointwise multiply; every rank holds both half spectra.
+    for (unsigned i = 0; i < h_width * p_height; ++i) {
+        a[i] *= b[i];
+    }
+    free_array(b);
+
+    // Inverse transform back to real samples
+    idft2d_c2r(a, padded, p_width, p_height, num_ranks, rank_id);
+    free_array(a);
+
+    // Crop the linear convolution out of the padded buffer.
+    result = alloc_array<T>(r_width * r_height);
+    for (unsigned y = 0; y < r_height; ++y) {
+        std::copy(&padded[y * p_width], &padded[y * p_width + r_width], &result[y * r_width]);
+    }
+    free_array(padded);
+}
+
+// ---------------------------------------------------------------------
+// Helper: Hermitian Expansion
+// Rebuilds the full width x height spectrum from the half spectrum
+// produced by dft2d_r2c(). Only needed when the caller wants every bin.
+// A row range restricts the expansion to one rank's output slab, and
+// 'full' then holds only those rows.
+// ---------------------------------------------------------------------
+template <typename T>
+void expand_hermitian(const std::complex<T> *half, std::complex<T> *full,
+                      const unsigned width, const unsigned height,
+                      const unsigned start_row = 0, unsigned num_rows = 0) {
+    const unsigned h_width = width / 2 + 1;
+    if (!num_rows) { num_rows = height - start_row; }
+
+    for (unsigned r = start_row; r < start_row + num_rows; ++r) {
+        for (unsigned c = 0; c < width; ++c) {
+            if (c < h_width) {
+                full[(r - start_row) * width + c] = half[r * h_width + c];
+            } else {
+                // X[r][c] = conj(X[(height - r) % height][width - c])
+                full[(r - start_row) * width + c] = std::conj(half[((height - r) % height) * h_width + (width - c)]);
+            }
+        }
+    }
 }
 
-#endif
\ No newline at end of file
+#endif
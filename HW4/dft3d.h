@@ -0,0 +1,277 @@
+/* dft3d.h */
+#ifndef __DFT3D_H__
+#define __DFT3D_H__
+
+#include <complex>
+#include <iostream>
+#include <mpi.h>
+#include <vector>
+#include "data.h"
+#include "dft.h"
+
+// ---------------------------------------------------------------------
+// Pencil Decomposition
+// A depth x height x width volume (z, y, x) is split over a P0 x P1
+// process grid. Every stage keeps one axis whole and contiguous:
+//   x-pencil [z][y][x]: z split over P0, y split over P1
+//   y-pencil [x][z][y]: x split over P1, z split over P0
+//   z-pencil [y][x][z]: y split over P0, x split over P1
+// Each split follows partition(), so uneven dimensions stay balanced,
+// and the grid can hold up to height x depth ranks instead of height.
+// ---------------------------------------------------------------------
+struct pencil_t {
+    MPI_Comm cart;                  // P0 x P1 process grid
+    MPI_Comm row_comm;              // Ranks sharing coords[0] (size P1)
+    MPI_Comm col_comm;              // Ranks sharing coords[1] (size P0)
+    int dims[2], coords[2];
+    unsigned depth, height, width;
+    int z0, nz;                     // z range (split over P0)
+    int y0, ny;                     // y range of the x-pencil (split over P1)
+    int x0, nx;                     // x range of the y- and z-pencils (split over P1)
+    int yz0, nyz;                   // y range of the z-pencil (split over P0)
+    size_t capacity;                // Elements needed by the largest pencil
+};
+
+inline void pencil_init(pencil_t &pencil, const unsigned depth, const unsigned height,
+                        const unsigned width, const int num_ranks) {
+    pencil.dims[0] = pencil.dims[1] = 0;
+    MPI_Dims_create(num_ranks, 2, pencil.dims);
+    int periods[2] = { 0, 0 };
+    // No reordering, so grid ranks stay equal to MPI_COMM_WORLD ranks.
+    MPI_Cart_create(MPI_COMM_WORLD, 2, pencil.dims, periods, 0, &pencil.cart);
+    int cart_rank = 0;
+    MPI_Comm_rank(pencil.cart, &cart_rank);
+    MPI_Cart_coords(pencil.cart, cart_rank, 2, pencil.coords);
+
+    int keep_row[2] = { 0, 1 }, keep_col[2] = { 1, 0 };
+    MPI_Cart_sub(pencil.cart, keep_row, &pencil.row_comm);
+    MPI_Cart_sub(pencil.cart, keep_col, &pencil.col_comm);
+
+    pencil.depth = depth;
+    pencil.height = height;
+    pencil.width = width;
+    partition(depth,  pencil.dims[0], pencil.coords[0], pencil.z0,  pencil.nz);
+    partition(height, pencil.dims[1], pencil.coords[1], pencil.y0,  pencil.ny);
+    partition(width,  pencil.dims[1], pencil.coords[1], pencil.x0,  pencil.nx);
+    partition(height, pencil.dims[0], pencil.coords[0], pencil.yz0, pencil.nyz);
+
+    pencil.capacity = std::max((size_t)pencil.nz * pencil.ny * width,
+                      std::max((size_t)pencil.nx * pencil.nz * height,
+                               (size_t)pencil.nyz * pencil.nx * depth));
+}
+
+inline void pencil_fin(pencil_t &pencil) {
+    MPI_Comm_free(&pencil.row_comm);
+    MPI_Comm_free(&pencil.col_comm);
+    MPI_Comm_free(&pencil.cart);
+}
+
+// ---------------------------------------------------------------------
+// Helper: Forward Pencil Transpose
+// Turns a local [A][B][C] block, whose B axis is split over 'comm' and
+// whose C axis is whole, into [C part][A][B whole] with one MPI_Alltoallv.
+// Both splits follow partition() over the ranks of 'comm'.
+// ---------------------------------------------------------------------
+template <typename T>
+void pencil_forward(std::complex<T> *data, const int a_size, const unsigned b_full,
+                    const unsigned c_full, MPI_Comm comm) {
+    int num_peers = 0, me = 0;
+    MPI_Comm_size(comm, &num_peers);
+    MPI_Comm_rank(comm, &me);
+
+    std::vector<int> b_start(num_peers), b_rows(num_peers), c_start(num_peers), c_rows(num_peers);
+    for (int q = 0; q < num_peers; ++q) {
+        partition(b_full, num_peers, q, b_start[q], b_rows[q]);
+        partition(c_full, num_peers, q, c_start[q], c_rows[q]);
+    }
+    const int nb = b_rows[me], nc = c_rows[me];
+
+    // Pack [c][a][b] for every peer's C part.
+    std::vector<int> send_counts(num_peers), send_displs(num_peers), recv_counts(num_peers), recv_displs(num_peers);
+    std::vector<std::complex<T> > send(a_size * nb * c_full), recv(nc * a_size * b_full);
+    for (int q = 0, offset = 0; q < num_peers; ++q) {
+        send_displs[q] = offset;
+        for (int c = c_start[q]; c < c_start[q] + c_rows[q]; ++c) {
+            for (int a = 0; a < a_size; ++a) {
+                for (int b = 0; b < nb; ++b) {
+                    send[offset++] = data[(a * nb + b) * c_full + c];
+                }
+            }
+        }
+        send_counts[q] = offset - send_displs[q];
+        recv_counts[q] = nc * a_size * b_rows[q];
+        recv_displs[q] = q ? recv_displs[q - 1] + recv_counts[q - 1] : 0;
+    }
+
+    MPI_Alltoallv(send.data(), send_counts.data(), send_displs.data(), MPI_COMPLEX,
+                  recv.data(), recv_counts.data(), recv_displs.data(), MPI_COMPLEX, comm);
+
+    // Unpack every peer's B part into [c][a][b whole].
+    for (int s = 0; s < num_peers; ++s) {
+        const std::complex<T> *block = &recv[recv_displs[s]];
+        for (int c = 0; c < nc; ++c) {
+            for (int a = 0; a < a_size; ++a) {
+                std::copy(block, block + b_rows[s], &data[(c * a_size + a) * b_full + b_start[s]]);
+                block += b_rows[s];
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------
+// Helper: Reverse Pencil Transpose
+// Undoes pencil_forward(): [C part][A][B whole] back to [A][B part][C whole].
+// ---------------------------------------------------------------------
+template <typename T>
+void pencil_reverse(std::complex<T> *data, const int a_size, const unsigned b_full,
+                    const unsigned c_full, MPI_Comm comm) {
+    int num_peers = 0, me = 0;
+    MPI_Comm_size(comm, &num_peers);
+    MPI_Comm_rank(comm, &me);
+
+    std::vector<int> b_start(num_peers), b_rows(num_peers), c_start(num_peers), c_rows(num_peers);
+    for (int q = 0; q < num_peers; ++q) {
+        partition(b_full, num_peers, q, b_start[q], b_rows[q]);
+        partition(c_full, num_peers, q, c_start[q], c_rows[q]);
+    }
+    const int nb = b_rows[me], nc = c_rows[me];
+
+    // Pack [c][a][b] for every peer's B part.
+    std::vector<int> send_counts(num_peers), send_displs(num_peers), recv_counts(num_peers), recv_displs(num_peers);
+    std::vector<std::complex<T> > send(nc * a_size * b_full), recv(a_size * nb * c_full);
+    for (int q = 0, offset = 0; q < num_peers; ++q) {
+        send_displs[q] = offset;
+        for (int c = 0; c < nc; ++c) {
+            for (int a = 0; a < a_size; ++a) {
+                const std::complex<T> *row = &data[(c * a_size + a) * b_full + b_start[q]];
+                std::copy(row, row + b_rows[q], &send[offset]);
+                offset += b_rows[q];
+            }
+        }
+        send_counts[q] = offset - send_displs[q];
+        recv_counts[q] = c_rows[q] * a_size * nb;
+        recv_displs[q] = q ? recv_displs[q - 1] + recv_counts[q - 1] : 0;
+    }
+
+    MPI_Alltoallv(send.data(), send_counts.data(), send_displs.data(), MPI_COMPLEX,
+                  recv.data(), recv_counts.data(), recv_displs.data(), MPI_COMPLEX, comm);
+
+    // Unpack every peer's C part into [a][b][c whole].
+    for (int s = 0; s < num_peers; ++s) {
+        const std::complex<T> *block = &recv[recv_displs[s]];
+        for (int c = c_start[s]; c < c_start[s] + c_rows[s]; ++c) {
+            for (int a = 0; a < a_size; ++a) {
+                for (int b = 0; b < nb; ++b) {
+                    data[(a * nb + b) * c_full + c] = *block++;
+                }
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------
+// Main Function: 3-D Discrete Fourier Transform
+// 'data' holds this rank's x-pencil and must have room for
+// pencil.capacity elements. The 1D transforms along x, y, and z run on
+// whole contiguous rows with the same fft_1d_iterative() kernel as
+// dft2d(); two sub-communicator all-to-alls move between the axes, and
+// two more restore the x-pencil layout on return.
+// ---------------------------------------------------------------------
+template <typename T>
+void dft3d(std::complex<T> *data, const pencil_t &pencil) {
+    const unsigned depth = pencil.depth, height = pencil.height, width = pencil.width;
+    fft_plan_t<T> x_plan(width), y_plan(height), z_plan(depth);
+
+    // --- Step a: 1D DFT along x on the x-pencil [z][y][x] ---
+    for (int r = 0; r < pencil.nz * pencil.ny; ++r) {
+        fft_1d_iterative(&data[r * width], x_plan);
+    }
+
+    // --- Step b: x-pencil -> y-pencil [x][z][y] within the grid row, then along y ---
+    pencil_forward(data, pencil.nz, height, width, pencil.row_comm);
+    for (int r = 0; r < pencil.nx * pencil.nz; ++r) {
+        fft_1d_iterative(&data[r * height], y_plan);
+    }
+
+    // --- Step c: y-pencil -> z-pencil [y][x][z] within the grid column, then along z ---
+    pencil_forward(data, pencil.nx, depth, height, pencil.col_comm);
+    for (int r = 0; r < pencil.nyz * pencil.nx; ++r) {
+        fft_1d_iterative(&data[r * depth], z_plan);
+    }
+
+    // --- Step d: Transpose back to the x-pencil ---
+    pencil_reverse(data, pencil.nx, depth, height, pencil.col_comm);
+    pencil_reverse(data, pencil.nz, height, width, pencil.row_comm);
+}
+
+// ---------------------------------------------------------------------
+// Helper: Read a Volume
+// Reads this rank's x-pencil of a complex64 binary file, whose header
+// depth is the number of z planes, through a subarray file view.
+// 'data' is allocated with room for pencil.capacity elements.
+// ---------------------------------------------------------------------
+template <typename T>
+void read3d(const char *file_name, std::complex<T> *&data, pencil_t &pencil,
+            const int num_ranks, const int rank_id) {
+    MPI_File fh = open_file(file_name, MPI_MODE_RDONLY, rank_id);
+    data_header_t header = read_header(fh, file_name, rank_id);
+    pencil_init(pencil, header.depth, header.height, header.width, num_ranks);
+    data = alloc_array<std::complex<T> >(pencil.capacity);
+
+    int sizes[3] = { (int)pencil.depth, (int)pencil.height, (int)pencil.width };
+    int subsizes[3] = { pencil.nz, pencil.ny, (int)pencil.width };
+    int starts[3] = { pencil.z0, pencil.y0, 0 };
+    MPI_Datatype view;
+    MPI_Type_create_subarray(3, sizes, subsizes, starts, MPI_ORDER_C, MPI_COMPLEX, &view);
+    MPI_Type_commit(&view);
+    MPI_File_set_view(fh, sizeof(data_header_t), MPI_COMPLEX, view, "native", MPI_INFO_NULL);
+    MPI_File_read_all(fh, data, pencil.nz * pencil.ny * pencil.width, MPI_COMPLEX, MPI_STATUS_IGNORE);
+    MPI_Type_free(&view);
+    MPI_File_close(&fh);
+}
+
+// ---------------------------------------------------------------------
+// Helper: Write a Volume
+// Stores the x-pencils as 'depth' consecutive write() images, one per z
+// plane, or as real32 magnitudes behind one header with 'binary'. Grid
+// ranks are ordered row-major, so the ranks holding one plane are
+// consecutive and an exclusive prefix sum of per-plane piece sizes gives
+// each piece its place within the plane.
+// ---------------------------------------------------------------------
+template <typename T>
+void write3d(const char *file_name, std::complex<T> *data, const pencil_t &pencil,
+             const bool binary, const int rank_id) {
+    const unsigned depth = pencil.depth, height = pencil.height, width = pencil.width;
+    std::vector<char> buffer;
+    std::vector<long long> sizes(depth, 0), offsets(depth, 0), totals(depth);
+    std::vector<size_t> starts(depth, 0);
+
+    // Format this rank's rows of every plane it holds.
+    for (int z = 0; z < pencil.nz; ++z) {
+        starts[pencil.z0 + z] = buffer.size();
+        format_rows(buffer, &data[z * pencil.ny * width], width, height, 0, pencil.ny,
+                    binary, !binary && !pencil.coords[1]);
+        sizes[pencil.z0 + z] = buffer.size() - starts[pencil.z0 + z];
+    }
+    MPI_Exscan(sizes.data(), offsets.data(), depth, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(sizes.data(), totals.data(), depth, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    if (!rank_id) { std::fill(offsets.begin(), offsets.end(), 0); }
+
+    MPI_File fh = open_file(file_name, MPI_MODE_CREATE|MPI_MODE_WRONLY, rank_id);
+    MPI_File_set_size(fh, 0);
+    long long base = 0;
+    if (binary) {
+        data_header_t header = make_header(real32, width, height, depth);
+        if (!rank_id) { MPI_File_write_at(fh, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE); }
+        base = sizeof(header);
+    }
+    for (unsigned z = 0; z < depth; ++z) {
+        if (sizes[z]) {
+            MPI_File_write_at(fh, base + offsets[z], &buffer[starts[z]], sizes[z], MPI_CHAR, MPI_STATUS_IGNORE);
+        }
+        base += totals[z];
+    }
+    MPI_File_close(&fh);
+}
+
+#endif
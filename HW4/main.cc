@@ -1,46 +1,229 @@
 #include <complex>
 #include <iostream>
 #include <mpi.h>
+#include <unistd.h>
 #include "abort.h"
 #include "data.h"
 #include "dft.h"
+#include "dft3d.h"
+#include "planner.h"
+#include "shm.h"
+#include "stream.h"
 #include "stopwatch.h"
 
 int main(int argc, char **argv) {
-    if(argc != 2) {                     // Run command message
-        std::cerr << "Usage: " << argv[0] << " <input_file>" << std::endl;
+    bool real_input = false;            // Real-to-complex path
+    const char *kernel_file = 0;        // Convolution kernel file
+    bool binary_output = false;         // Binary magnitude output
+    bool shared_memory = false;         // Intra-node shared-memory mode
+    bool stream = false;                // Streaming multi-frame mode
+    unsigned batch = 0;                 // Frames per batch in streaming mode (0: planner's choice)
+    bool volume = false;                // 3-D transform of a binary volume
+    wisdom_mode planner = wisdom_estimate; // Planner mode
+    const char *wisdom_file = "wisdom"; // Wisdom file
+    bool wire_check = false;            // Compare the wire format against fp32
+    bool bad_option = false;            // Unknown command-line option
+    int opt;
+    while((opt = getopt(argc, argv, "rk:msf:vp:w:z:e")) != -1) {
+        switch(opt) {
+            case 'r': { real_input = true; break; }
+            case 'k': { kernel_file = optarg; break; }
+            case 'm': { binary_output = true; break; }
+            case 's': { shared_memory = true; break; }
+            case 'f': { stream = true; batch = (unsigned)atoi(optarg); break; }
+            case 'v': { volume = true; break; }
+            case 'p': { bad_option |= !parse_wisdom_mode(optarg, planner); break; }
+            case 'w': { wisdom_file = optarg; break; }
+            case 'z': { bad_option |= !parse_wire_format(optarg, fft_wire); break; }
+            case 'e': { wire_check = true; break; }
+            default:  { bad_option = true; break; }
+        }
+    }
+    if(bad_option || (optind != argc - 1) ||
+       ((real_input || kernel_file) + shared_memory + stream + volume > 1) ||
+       (wire_check && (real_input || kernel_file || shared_memory || stream || volume))) { // Run command message
+        std::cerr << "Usage: " << argv[0] << " [[-r] [-k <kernel_file>] | -s | -f <batch> | -v] [-m]" << std::endl
+                  << "       [-p estimate|measure|load] [-w <wisdom_file>] [-z fp32|bf16|bfp [-e]] <input_file>" << std::endl
+                  << "  -r  treat the input as real-valued (r2c transform)" << std::endl
+                  << "  -k  convolve the input with the kernel instead of transforming it" << std::endl
+                  << "      (with -r, both are real-valued and go through r2c/c2r transforms)" << std::endl
+                  << "  -s  share one matrix per node through MPI-3 shared windows" << std::endl
+                  << "  -f  stream every frame of a binary input, <batch> frames at a time (0: planner's choice)" << std::endl
+                  << "  -v  3-D transform of a binary input whose depth is the volume depth" << std::endl
+                  << "  -m  store binary real32 magnitudes instead of text" << std::endl
+                  << "  -p  planner mode: built-in estimates (default), measure unless the" << std::endl
+                  << "      wisdom file has this problem, or load the wisdom file only" << std::endl
+                  << "  -w  wisdom file (default: wisdom)" << std::endl
+                  << "  -z  row exchange format: fp32 (default), bf16, or block floating point" << std::endl
+                  << "  -e  also run the fp32 exchange and report the error (plain transform only)" << std::endl;
         exit(1);
     }
 
-    const char *data_file = argv[1];    // Input file
+    const char *data_file = argv[optind]; // Input file
     std::complex<float> *data = 0;      // Data array
+    float *real_data = 0;               // Real-valued input for the r2c path
+    float *real_kernel = 0;             // Real-valued kernel for r2c convolution
+    std::complex<float> *kernel = 0;    // Convolution kernel
     unsigned width = 0, height = 0;     // Data dimension
+    unsigned k_width = 0, k_height = 0; // Kernel dimension
     int num_ranks = 0;                  // Communicator size
     int rank_id = -1;                   // Rank ID
 
-    // Read data file.
-    read(data_file, data, width, height);
-    //std::cout <<"hello?"<<std::endl;
-    //std::cout << data[0].real() << " " << data[0].imag() <<std::endl;
     // Initialize MPI.
     abort(MPI_Init(&argc, &argv));
     // Get the communicator size and rank ID.
     abort(MPI_Comm_size(MPI_COMM_WORLD, &num_ranks));
     abort(MPI_Comm_rank(MPI_COMM_WORLD, &rank_id));
 
+    // Streaming mode reads, transforms, and writes frame by frame.
+    if(stream) {
+        MPI_File in = open_file(data_file, MPI_MODE_RDONLY, rank_id);
+        data_header_t header = read_header(in, data_file, rank_id);
+        MPI_File_close(&in);
+        plan_fft<float>(header.width, header.height, true, planner, wisdom_file, num_ranks, rank_id);
+        if(!batch) { batch = fft_tuning.batch; }
+
+        stopwatch_t stopwatch;
+        MPI_Barrier(MPI_COMM_WORLD);
+        double start_time = MPI_Wtime();
+        stopwatch.start();
+        unsigned frames = dft2d_stream<float>(data_file, "result", batch, binary_output, num_ranks, rank_id);
+        stopwatch.stop();
+        double elapsed_time = MPI_Wtime() - start_time;
+        if(!rank_id) {
+            stopwatch.display();
+            std::cout << "Throughput = " << frames / elapsed_time << " frames/s" << std::endl;
+        }
+        abort(MPI_Finalize());
+        return 0;
+    }
+
+    // Volume mode transforms x-pencils over a 2-D process grid.
+    if(volume) {
+        pencil_t pencil;
+        read3d(data_file, data, pencil, num_ranks, rank_id);
+        plan_fft<float>(pencil.width, pencil.height, false, planner, wisdom_file, num_ranks, rank_id);
+        stopwatch_t stopwatch;
+        stopwatch.start();
+        dft3d(data, pencil);
+        stopwatch.stop();
+        if(!rank_id) { stopwatch.display(); }
+        write3d("result", data, pencil, binary_output, rank_id);
+        pencil_fin(pencil);
+        abort(MPI_Finalize());
+        fin(data);
+        return 0;
+    }
+
+    // Read data file. Binary files are read in row slabs with MPI-IO,
+    // except for convolution, which pads the full inputs on every rank.
+    if(real_input) { read(data_file, real_data, width, height, num_ranks, rank_id, !kernel_file, kernel_file != 0); }
+    else           { read(data_file, data, width, height, num_ranks, rank_id, !kernel_file, kernel_file != 0); }
+    if(kernel_file && real_input) { read(kernel_file, real_kernel, k_width, k_height, num_ranks, rank_id, false, true); }
+    else if(kernel_file)          { read(kernel_file, kernel, k_width, k_height, num_ranks, rank_id, false, true); }
+
+    // Tune for the transform size; convolution transforms the padded result size.
+    if(kernel_file) { plan_fft<float>(width + k_width - 1, height + k_height - 1, false, planner, wisdom_file, num_ranks, rank_id); }
+    else            { plan_fft<float>(width, height, false, planner, wisdom_file, num_ranks, rank_id); }
+
+    // Shared-memory mode keeps one matrix (and its transpose scratch) per node.
+    node_t node;
+    MPI_Win win = MPI_WIN_NULL;
+    if(shared_memory) {
+        if(node_init(node, rank_id)) {
+            std::complex<float> *shared = shared_alloc<std::complex<float> >(node, 2 * width * height, win);
+            // Move this rank's input rows into the shared matrix.
+            int my_start_row = 0, my_num_rows = 0;
+            partition(height, num_ranks, rank_id, my_start_row, my_num_rows);
+            std::copy(&data[my_start_row * width], &data[(my_start_row + my_num_rows) * width],
+                      &shared[my_start_row * width]);
+            fin(data);
+            data = shared;
+        }
+        else {
+            if(!rank_id) { std::cerr << "Warning: ranks are not contiguous per node; -s ignored" << std::endl; }
+            node_fin(node);
+            shared_memory = false;
+        }
+    }
+
     stopwatch_t stopwatch;
     stopwatch.start();
-    // Two-dimensional discrete Fourier transform
-    dft2d(data, width, height, num_ranks, rank_id);
+    if(real_input && kernel_file) {
+        // Real linear convolution through half spectra; the result replaces the input.
+        float *image = real_data;
+        convolve2d_r2c(image, width, height, real_kernel, k_width, k_height,
+                       real_data, width, height, num_ranks, rank_id);
+        fin(image);
+    }
+    else if(real_input) {
+        // Real-to-complex transform keeps only the Hermitian half, height x (width/2+1).
+        data = alloc_array<std::complex<float> >(height * (width / 2 + 1));
+        dft2d_r2c(real_data, data, width, height, num_ranks, rank_id);
+    }
+    else if(kernel_file) {
+        // FFT-based linear convolution; the result replaces the input.
+        std::complex<float> *image = data;
+        convolve2d(image, width, height, kernel, k_width, k_height,
+                   data, width, height, num_ranks, rank_id);
+        fin(image);
+    }
+    else if(shared_memory) {
+        // Two-dimensional discrete Fourier transform in node shared memory
+        dft2d_shared(data, data + width * height, win, width, height, node, num_ranks, rank_id);
+    }
+    else {
+        // Two-dimensional discrete Fourier transform
+        dft2d(data, width, height, num_ranks, rank_id);
+    }
     stopwatch.stop();
-    // Rank 0 displays the runtime and stores the final result to a file.
-    if(!rank_id) { stopwatch.display(); write("result", data, width, height); } 
+    // Rank 0 displays the runtime.
+    if(!rank_id) { stopwatch.display(); }
+    // Rank 0 compares the reduced wire format with an fp32 exchange of the same input.
+    if(wire_check) {
+        std::complex<float> *reference = 0;
+        read(data_file, reference, width, height, num_ranks, rank_id, false);
+        wire_format format = fft_wire;
+        fft_wire = wire_fp32;
+        dft2d(reference, width, height, num_ranks, rank_id);
+        fft_wire = format;
+        if(!rank_id) {
+            double max_error = 0.0, max_value = 0.0;
+            for(unsigned i = 0; i < width * height; i++) {
+                max_error = std::max(max_error, (double)std::abs(data[i] - reference[i]));
+                max_value = std::max(max_value, (double)std::abs(reference[i]));
+            }
+            std::cout << "Wire error vs fp32: max abs " << max_error << ", relative to max "
+                      << max_error / max_value << std::endl;
+        }
+        fin(reference);
+    }
+    // All ranks store the final result to a file, each writing its own row slab.
+    if(real_input && kernel_file) { write("result", real_data, width, height, num_ranks, rank_id, binary_output); }
+    else if(real_input) {
+        // Expand this rank's slab of the half spectrum to the full spectrum.
+        int my_start_row = 0, my_num_rows = 0;
+        partition(height, num_ranks, rank_id, my_start_row, my_num_rows);
+        std::complex<float> *slab = alloc_array<std::complex<float> >(my_num_rows * width);
+        expand_hermitian(data, slab, width, height, my_start_row, my_num_rows);
+        write_slab("result", slab, width, height, my_num_rows, rank_id, binary_output);
+        fin(slab);
+    }
+    else { write("result", data, width, height, num_ranks, rank_id, binary_output); }
 
+    // Release the shared window before finalizing.
+    if(shared_memory) {
+        MPI_Win_free(&win);
+        node_fin(node);
+        data = 0;
+    }
     // Finalize MPI.
     abort(MPI_Finalize());
     // Close data.
     fin(data);
+    if(real_data) { fin(real_data); }
+    if(kernel) { fin(kernel); }
+    if(real_kernel) { fin(real_kernel); }
 
     return 0;
 }
-
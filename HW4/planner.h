@@ -0,0 +1,167 @@
+/* planner.h */
+#ifndef __PLANNER_H__
+#define __PLANNER_H__
+
+#include <complex>
+#include <iostream>
+#include <mpi.h>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "dft.h"
+#include "wisdom.h"
+
+// Candidate values tried in measure mode
+const unsigned codelet_candidates[] = { 8, 16, 32, 64 };
+const unsigned tile_candidates[] = { 0, 16, 32, 64, 128 };
+const unsigned batch_candidates[] = { 1, 2, 4, 8 };
+
+// ---------------------------------------------------------------------
+// Helper: Shared Wisdom Lookup
+// Rank 0 looks the problem up and broadcasts the result, so every rank
+// applies the same choice.
+// ---------------------------------------------------------------------
+inline bool lookup_all(const wisdom_t &wisdom, const std::string &problem, std::vector<long> &values,
+                       const size_t count, const int rank_id) {
+    int found = 0;
+    if (!rank_id) { found = wisdom.lookup(problem, values) && (values.size() == count); }
+    MPI_Bcast(&found, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    values.resize(count);
+    if (found) { MPI_Bcast(values.data(), count, MPI_LONG, 0, MPI_COMM_WORLD); }
+    return found;
+}
+
+// Check that a value from the wisdom file is one of the candidates. Any
+// other value, e.g. a codelet size of 0 or one that is not a power of
+// two, would hang or break the transform, so such entries are ignored.
+inline bool is_candidate(const long value, const unsigned *candidates, const size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if (value == (long)candidates[i]) { return true; }
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------------
+// Helper: Time a Distributed Transform
+// Best of three forward transforms of 'frames' zero frames, as seen by
+// the slowest rank. Zeros stay zeros, so repeated runs never overflow.
+// ---------------------------------------------------------------------
+template <typename T>
+double time_dft2d(std::complex<T> *buffer, const unsigned width, const unsigned height,
+                  const unsigned frames, const int num_ranks, const int rank_id) {
+    fft_plan_t<T> row_plan(width), col_plan(height);
+    double local = best_time([&]() {
+        MPI_Barrier(MPI_COMM_WORLD);
+        dft2d_to_transposed(buffer, width, height, row_plan, col_plan, fft_forward, num_ranks, rank_id, frames);
+        dft2d_transpose_back(buffer, width, height, num_ranks, rank_id, frames);
+    }, 3);
+    double slowest = 0.0;
+    MPI_Allreduce(&local, &slowest, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    return slowest;
+}
+
+// Set 'knob' to the candidate for which time() is lowest.
+template <typename F>
+void pick_fastest(unsigned &knob, const unsigned *candidates, const size_t count, F time) {
+    double best = 0.0;
+    unsigned choice = knob;
+    for (size_t i = 0; i < count; ++i) {
+        knob = candidates[i];
+        double elapsed = time();
+        if (!i || (elapsed < best)) { best = elapsed; choice = knob; }
+    }
+    knob = choice;
+}
+
+// ---------------------------------------------------------------------
+// FFT Planner
+// Sets fft_tuning for width x height transforms on 'num_ranks' ranks.
+// wisdom_estimate keeps the built-in defaults. wisdom_load takes the
+// choices from 'wisdom_file' when it has them for this CPU model, size,
+// and rank count, and ignores entries that are not among the candidates.
+// wisdom_measure does the same, but otherwise times the
+// candidates one parameter at a time (codelet size, then transpose tile,
+// then the streaming batch if 'stream') and adds the winners to the file.
+// Sizes are rounded up to the power of two that is actually transformed.
+// ---------------------------------------------------------------------
+template <typename T>
+void plan_fft(unsigned width, unsigned height, const bool stream, const wisdom_mode mode,
+              const char *wisdom_file, const int num_ranks, const int rank_id) {
+    if (mode == wisdom_estimate) { return; }
+    unsigned p_width = 1, p_height = 1;
+    while (p_width < width) { p_width <<= 1; }
+    while (p_height < height) { p_height <<= 1; }
+    width = p_width;
+    height = p_height;
+
+    wisdom_t wisdom;
+    if (!rank_id) { wisdom.load(wisdom_file); }
+    std::ostringstream size;
+    size << width << "x" << height << " ranks=" << num_ranks;
+    const std::string fft_problem = "fft " + size.str(), stream_problem = "stream " + size.str();
+
+    std::vector<long> values;
+    bool measured = false, missing = false, rejected = false;
+    std::vector<std::complex<T> > buffer;
+
+    // Codelet size and transpose tile
+    bool found = lookup_all(wisdom, fft_problem, values, 2, rank_id);
+    if (found && !(is_candidate(values[0], codelet_candidates, sizeof(codelet_candidates) / sizeof(unsigned)) &&
+                   is_candidate(values[1], tile_candidates, sizeof(tile_candidates) / sizeof(unsigned)))) {
+        found = false;
+        rejected = true;
+    }
+    if (found) {
+        fft_tuning.codelet_max = values[0];
+        fft_tuning.tile = values[1];
+    }
+    else if (mode == wisdom_measure) {
+        buffer.resize((size_t)width * height);
+        pick_fastest(fft_tuning.codelet_max, codelet_candidates, sizeof(codelet_candidates) / sizeof(unsigned),
+                     [&]() { return time_dft2d(buffer.data(), width, height, 1, num_ranks, rank_id); });
+        pick_fastest(fft_tuning.tile, tile_candidates, sizeof(tile_candidates) / sizeof(unsigned),
+                     [&]() { return time_dft2d(buffer.data(), width, height, 1, num_ranks, rank_id); });
+        wisdom.store(fft_problem, std::vector<long>{ fft_tuning.codelet_max, fft_tuning.tile });
+        measured = true;
+    }
+    else { missing = true; }
+
+    // Frames per streaming batch, compared by time per frame
+    if (stream) {
+        found = lookup_all(wisdom, stream_problem, values, 1, rank_id);
+        if (found && !is_candidate(values[0], batch_candidates, sizeof(batch_candidates) / sizeof(unsigned))) {
+            found = false;
+            rejected = true;
+        }
+        if (found) {
+            fft_tuning.batch = values[0];
+        }
+        else if (mode == wisdom_measure) {
+            buffer.resize((size_t)width * height * batch_candidates[sizeof(batch_candidates) / sizeof(unsigned) - 1]);
+            pick_fastest(fft_tuning.batch, batch_candidates, sizeof(batch_candidates) / sizeof(unsigned),
+                         [&]() { return time_dft2d(buffer.data(), width, height, fft_tuning.batch,
+                                                   num_ranks, rank_id) / fft_tuning.batch; });
+            wisdom.store(stream_problem, std::vector<long>{ fft_tuning.batch });
+            measured = true;
+        }
+        else { missing = true; }
+    }
+
+    if (!rank_id) {
+        if (rejected) {
+            std::cerr << "Warning: ignoring invalid wisdom for " << size.str() << " in " << wisdom_file << std::endl;
+        }
+        if (measured) {
+            wisdom.save(wisdom_file);
+            std::cout << "Planner: codelet " << fft_tuning.codelet_max << ", tile " << fft_tuning.tile;
+            if (stream) { std::cout << ", batch " << fft_tuning.batch; }
+            std::cout << " (saved to " << wisdom_file << ")" << std::endl;
+        }
+        if (missing) {
+            std::cerr << "Warning: no wisdom for " << size.str() << " in " << wisdom_file
+                      << "; using estimates" << std::endl;
+        }
+    }
+}
+
+#endif
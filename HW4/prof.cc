@@ -0,0 +1,298 @@
+/* prof.cc */
+// PMPI profiling layer, linked into the mpi target with "make PROF=1".
+// Every wrapped call is timed and forwarded to its PMPI_ counterpart.
+// At MPI_Finalize all ranks' counters are gathered to rank 0, which
+// prints a per-rank table and a per-call summary. If the PROF_TRACE
+// environment variable names a file, rank 0 also writes a Chrome trace
+// (chrome://tracing, Perfetto) of every call and phase of every rank.
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mpi.h>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "prof.h"
+
+namespace {
+
+// Wrapped calls
+enum prof_call { call_send = 0, call_isend, call_recv, call_irecv, call_wait, call_waitall,
+                 call_barrier, call_bcast, call_allreduce, call_allgatherv, call_alltoallv,
+                 call_exscan, num_calls };
+const char *call_names[num_calls] = { "MPI_Send", "MPI_Isend", "MPI_Recv", "MPI_Irecv", "MPI_Wait",
+                                      "MPI_Waitall", "MPI_Barrier", "MPI_Bcast", "MPI_Allreduce",
+                                      "MPI_Allgatherv", "MPI_Alltoallv", "MPI_Exscan" };
+const char *phase_names[num_phases] = { "other", "row-fft", "row-gather", "transpose", "col-fft", "col-gather" };
+
+// Counters of one rank, all doubles so that one MPI_Gather moves them.
+struct counters_t {
+    double calls[num_calls];        // Number of calls
+    double call_time[num_calls];    // Seconds in each call
+    double messages;                // Point-to-point messages sent
+    double bytes_sent;              // Bytes sent (point-to-point and collective contributions)
+    double bytes_recv;              // Bytes posted for receiving
+    double phase_time[num_phases];  // Wall time in each phase
+    double phase_mpi[num_phases];   // Time in MPI calls within each phase
+};
+
+// One timeline event: a call (name < num_calls) or a phase
+struct event_t {
+    int name;
+    double start, duration;
+};
+
+counters_t counters;
+std::vector<event_t> events;
+bool tracing = false;
+int depth = 0;                      // Nesting of wrapped calls made by MPI itself
+int phase = phase_other;
+double origin = 0.0, phase_start = 0.0;
+
+// Times one wrapped call and charges it to the current phase.
+class scope_t {
+public:
+    scope_t(const prof_call m_call, const double m_sent = 0.0, const double m_recv = 0.0,
+            const double m_messages = 0.0) : call(m_call), start(PMPI_Wtime()) {
+        if(depth++) { return; }
+        counters.calls[call]++;
+        counters.messages += m_messages;
+        counters.bytes_sent += m_sent;
+        counters.bytes_recv += m_recv;
+    }
+    ~scope_t() {
+        if(--depth) { return; }
+        double duration = PMPI_Wtime() - start;
+        counters.call_time[call] += duration;
+        counters.phase_mpi[phase] += duration;
+        if(tracing) { events.push_back({ call, start - origin, duration }); }
+    }
+
+private:
+    prof_call call;
+    double start;
+};
+
+double bytes(const int count, MPI_Datatype type) {
+    int size = 0;
+    PMPI_Type_size(type, &size);
+    return (double)count * size;
+}
+
+double bytes(const int *counts, const int n, MPI_Datatype type) {
+    double total = 0.0;
+    for(int i = 0; i < n; i++) { total += bytes(counts[i], type); }
+    return total;
+}
+
+int comm_size(MPI_Comm comm) {
+    int size = 0;
+    PMPI_Comm_size(comm, &size);
+    return size;
+}
+
+// Close the current phase and open 'next'.
+void switch_phase(const int next) {
+    double now = PMPI_Wtime();
+    counters.phase_time[phase] += now - phase_start;
+    if(tracing && (phase != phase_other)) {
+        events.push_back({ num_calls + phase, phase_start - origin, now - phase_start });
+    }
+    phase = next;
+    phase_start = now;
+}
+
+// Rank 0 prints the per-rank table and the per-call summary.
+void report(const std::vector<counters_t> &all) {
+    const int num_ranks = all.size();
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    out << "MPI profile: " << num_ranks << " ranks (times in msec)" << std::endl;
+    out << std::setw(5) << "rank" << std::setw(8) << "msgs" << std::setw(10) << "sent MB" << std::setw(10) << "recv MB"
+        << std::setw(10) << "MPI" << std::setw(10) << "row-fft" << std::setw(10) << "row-wait"
+        << std::setw(10) << "transpose" << std::setw(10) << "col-fft" << std::setw(10) << "col-wait"
+        << std::setw(10) << "other" << std::endl;
+
+    std::vector<double> sum(6, 0.0), max(6, 0.0);
+    for(int r = 0; r < num_ranks; r++) {
+        const counters_t &c = all[r];
+        double mpi = 0.0;
+        for(int i = 0; i < num_calls; i++) { mpi += c.call_time[i]; }
+        double columns[6] = { mpi, c.phase_time[phase_row_fft], c.phase_mpi[phase_row_gather],
+                              c.phase_time[phase_transpose], c.phase_time[phase_col_fft], c.phase_mpi[phase_col_gather] };
+        out << std::setw(5) << r << std::setw(8) << (long)c.messages
+            << std::setw(10) << c.bytes_sent / 1e6 << std::setw(10) << c.bytes_recv / 1e6;
+        for(int i = 0; i < 6; i++) {
+            out << std::setw(10) << columns[i] * 1e3;
+            sum[i] += columns[i];
+            if(columns[i] > max[i]) { max[i] = columns[i]; }
+        }
+        out << std::setw(10) << c.phase_time[phase_other] * 1e3 << std::endl;
+    }
+    // Imbalance: slowest rank over the average, per column
+    out << std::setw(33) << "max/avg";
+    for(int i = 0; i < 6; i++) { out << std::setw(10) << (sum[i] > 0.0 ? max[i] * num_ranks / sum[i] : 0.0); }
+    out << std::endl << std::endl;
+
+    out << std::setw(16) << "call" << std::setw(10) << "count" << std::setw(12) << "total" << std::setw(12) << "max rank" << std::endl;
+    for(int i = 0; i < num_calls; i++) {
+        double count = 0.0, total = 0.0, slowest = 0.0;
+        for(int r = 0; r < num_ranks; r++) {
+            count += all[r].calls[i];
+            total += all[r].call_time[i];
+            if(all[r].call_time[i] > slowest) { slowest = all[r].call_time[i]; }
+        }
+        if(!count) { continue; }
+        out << std::setw(16) << call_names[i] << std::setw(10) << (long)count
+            << std::setw(12) << total * 1e3 << std::setw(12) << slowest * 1e3 << std::endl;
+    }
+    std::cout << out.str();
+}
+
+// Gather every rank's events to rank 0 and write them as a Chrome trace.
+void write_trace(const char *file_name, const int rank_id, const int num_ranks) {
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(3);
+    for(size_t i = 0; i < events.size(); i++) {
+        const event_t &e = events[i];
+        bool is_call = e.name < num_calls;
+        json << "{\"name\":\"" << (is_call ? call_names[e.name] : phase_names[e.name - num_calls])
+             << "\",\"cat\":\"" << (is_call ? "mpi" : "phase") << "\",\"ph\":\"X\",\"pid\":" << rank_id
+             << ",\"tid\":" << (is_call ? 1 : 0) << ",\"ts\":" << e.start * 1e6 << ",\"dur\":" << e.duration * 1e6 << "},\n";
+    }
+    std::string text = json.str();
+
+    int length = text.size();
+    std::vector<int> lengths(num_ranks), displs(num_ranks, 0);
+    PMPI_Gather(&length, 1, MPI_INT, lengths.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+    for(int r = 1; r < num_ranks; r++) { displs[r] = displs[r - 1] + lengths[r - 1]; }
+    std::vector<char> all(rank_id ? 0 : displs[num_ranks - 1] + lengths[num_ranks - 1]);
+    PMPI_Gatherv(text.data(), length, MPI_CHAR, all.data(), lengths.data(), displs.data(), MPI_CHAR, 0, MPI_COMM_WORLD);
+
+    if(!rank_id) {
+        std::ofstream fs(file_name);
+        if(!fs.is_open()) { std::cerr << "Error: failed to open " << file_name << std::endl; return; }
+        fs << "{\"traceEvents\":[\n";
+        for(int r = 0; r < num_ranks; r++) {
+            fs << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << r << ",\"args\":{\"name\":\"rank " << r << "\"}},\n";
+        }
+        fs.write(all.data(), all.size());
+        fs << "{}]}" << std::endl;
+        std::cout << "Trace written to " << file_name << std::endl;
+    }
+}
+
+}
+
+extern "C" {
+
+int MPI_Init(int *argc, char ***argv) {
+    int result = PMPI_Init(argc, argv);
+    tracing = getenv("PROF_TRACE") != 0;
+    // Start every rank's clock together so that timelines line up.
+    PMPI_Barrier(MPI_COMM_WORLD);
+    origin = phase_start = PMPI_Wtime();
+    return result;
+}
+
+int MPI_Finalize(void) {
+    switch_phase(phase_other);
+    int rank_id = 0, num_ranks = 0;
+    PMPI_Comm_rank(MPI_COMM_WORLD, &rank_id);
+    PMPI_Comm_size(MPI_COMM_WORLD, &num_ranks);
+
+    std::vector<counters_t> all(rank_id ? 0 : num_ranks);
+    const int count = sizeof(counters_t) / sizeof(double);
+    PMPI_Gather(&counters, count, MPI_DOUBLE, all.data(), count, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    if(!rank_id) { report(all); }
+    if(tracing) { write_trace(getenv("PROF_TRACE"), rank_id, num_ranks); }
+
+    return PMPI_Finalize();
+}
+
+// The level passed to MPI_Pcontrol() is the prof_phase being entered.
+int MPI_Pcontrol(const int level, ...) {
+    if((level >= 0) && (level < num_phases) && (level != phase)) { switch_phase(level); }
+    return MPI_SUCCESS;
+}
+
+int MPI_Send(const void *buf, int count, MPI_Datatype datatype, int dest, int tag, MPI_Comm comm) {
+    scope_t scope(call_send, bytes(count, datatype), 0.0, 1.0);
+    return PMPI_Send(buf, count, datatype, dest, tag, comm);
+}
+
+int MPI_Isend(const void *buf, int count, MPI_Datatype datatype, int dest, int tag, MPI_Comm comm,
+              MPI_Request *request) {
+    scope_t scope(call_isend, bytes(count, datatype), 0.0, 1.0);
+    return PMPI_Isend(buf, count, datatype, dest, tag, comm, request);
+}
+
+int MPI_Recv(void *buf, int count, MPI_Datatype datatype, int source, int tag, MPI_Comm comm,
+             MPI_Status *status) {
+    scope_t scope(call_recv, 0.0, bytes(count, datatype));
+    return PMPI_Recv(buf, count, datatype, source, tag, comm, status);
+}
+
+int MPI_Irecv(void *buf, int count, MPI_Datatype datatype, int source, int tag, MPI_Comm comm,
+              MPI_Request *request) {
+    scope_t scope(call_irecv, 0.0, bytes(count, datatype));
+    return PMPI_Irecv(buf, count, datatype, source, tag, comm, request);
+}
+
+int MPI_Wait(MPI_Request *request, MPI_Status *status) {
+    scope_t scope(call_wait);
+    return PMPI_Wait(request, status);
+}
+
+int MPI_Waitall(int count, MPI_Request array_of_requests[], MPI_Status *array_of_statuses) {
+    scope_t scope(call_waitall);
+    return PMPI_Waitall(count, array_of_requests, array_of_statuses);
+}
+
+int MPI_Barrier(MPI_Comm comm) {
+    scope_t scope(call_barrier);
+    return PMPI_Barrier(comm);
+}
+
+int MPI_Bcast(void *buffer, int count, MPI_Datatype datatype, int root, MPI_Comm comm) {
+    int rank_id = 0;
+    PMPI_Comm_rank(comm, &rank_id);
+    double size = bytes(count, datatype);
+    scope_t scope(call_bcast, rank_id == root ? size : 0.0, rank_id == root ? 0.0 : size);
+    return PMPI_Bcast(buffer, count, datatype, root, comm);
+}
+
+int MPI_Allreduce(const void *sendbuf, void *recvbuf, int count, MPI_Datatype datatype, MPI_Op op,
+                  MPI_Comm comm) {
+    scope_t scope(call_allreduce, bytes(count, datatype), bytes(count, datatype));
+    return PMPI_Allreduce(sendbuf, recvbuf, count, datatype, op, comm);
+}
+
+int MPI_Allgatherv(const void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf,
+                   const int recvcounts[], const int displs[], MPI_Datatype recvtype, MPI_Comm comm) {
+    int rank_id = 0;
+    PMPI_Comm_rank(comm, &rank_id);
+    double sent = sendbuf == MPI_IN_PLACE ? bytes(recvcounts[rank_id], recvtype) : bytes(sendcount, sendtype);
+    scope_t scope(call_allgatherv, sent, bytes(recvcounts, comm_size(comm), recvtype));
+    return PMPI_Allgatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts, displs, recvtype, comm);
+}
+
+int MPI_Alltoallv(const void *sendbuf, const int sendcounts[], const int sdispls[], MPI_Datatype sendtype,
+                  void *recvbuf, const int recvcounts[], const int rdispls[], MPI_Datatype recvtype,
+                  MPI_Comm comm) {
+    int n = comm_size(comm);
+    scope_t scope(call_alltoallv, bytes(sendcounts, n, sendtype), bytes(recvcounts, n, recvtype));
+    return PMPI_Alltoallv(sendbuf, sendcounts, sdispls, sendtype, recvbuf, recvcounts, rdispls, recvtype, comm);
+}
+
+int MPI_Exscan(const void *sendbuf, void *recvbuf, int count, MPI_Datatype datatype, MPI_Op op,
+               MPI_Comm comm) {
+    scope_t scope(call_exscan, bytes(count, datatype), bytes(count, datatype));
+    return PMPI_Exscan(sendbuf, recvbuf, count, datatype, op, comm);
+}
+
+}
@@ -0,0 +1,18 @@
+/* prof.h */
+#ifndef __PROF_H__
+#define __PROF_H__
+
+#include <mpi.h>
+
+// ---------------------------------------------------------------------
+// Profiling Phases
+// The transform marks where it is through MPI_Pcontrol(), which MPI
+// ignores unless the PMPI profiling layer (prof.cc, make PROF=1) is
+// linked in. Time and MPI wait time are then split by these phases.
+// ---------------------------------------------------------------------
+enum prof_phase { phase_other = 0, phase_row_fft, phase_row_gather, phase_transpose,
+                  phase_col_fft, phase_col_gather, num_phases };
+
+inline void mark_phase(const prof_phase phase) { MPI_Pcontrol(phase); }
+
+#endif
@@ -0,0 +1,157 @@
+/* shm.h */
+#ifndef __SHM_H__
+#define __SHM_H__
+
+#include <complex>
+#include <mpi.h>
+#include <vector>
+#include "data.h"
+#include "dft.h"
+
+// ---------------------------------------------------------------------
+// Node Layout
+// Groups the ranks that share memory (MPI_COMM_TYPE_SHARED). Rank 0 of
+// each node is its leader, and only leaders exchange MPI messages.
+// ---------------------------------------------------------------------
+struct node_t {
+    MPI_Comm node_comm;             // Ranks on this node
+    MPI_Comm leader_comm;           // Node leaders (MPI_COMM_NULL on other ranks)
+    int node_rank, node_size;       // Rank and size within the node
+    int num_nodes;                  // Number of nodes
+    std::vector<int> first_rank;    // First world rank of every node (leaders only)
+    std::vector<int> node_sizes;    // Number of ranks on every node (leaders only)
+};
+
+// ---------------------------------------------------------------------
+// Helper: Detect Co-located Ranks
+// Returns false if the ranks of a node are not contiguous in
+// MPI_COMM_WORLD. Node slabs then could not be contiguous row blocks, so
+// the caller should fall back to the message-passing dft2d().
+// ---------------------------------------------------------------------
+inline bool node_init(node_t &node, const int rank_id) {
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank_id, MPI_INFO_NULL, &node.node_comm);
+    MPI_Comm_rank(node.node_comm, &node.node_rank);
+    MPI_Comm_size(node.node_comm, &node.node_size);
+
+    // Ranks of a node are contiguous iff rank_id - node_rank is the same on all of them.
+    int first = rank_id - node.node_rank, min_first = 0, max_first = 0;
+    MPI_Allreduce(&first, &min_first, 1, MPI_INT, MPI_MIN, node.node_comm);
+    MPI_Allreduce(&first, &max_first, 1, MPI_INT, MPI_MAX, node.node_comm);
+    int contiguous = (min_first == max_first), all_contiguous = 0;
+    MPI_Allreduce(&contiguous, &all_contiguous, 1, MPI_INT, MPI_LAND, MPI_COMM_WORLD);
+
+    // Leaders learn where every node's ranks start.
+    MPI_Comm_split(MPI_COMM_WORLD, node.node_rank ? MPI_UNDEFINED : 0, rank_id, &node.leader_comm);
+    if (node.leader_comm != MPI_COMM_NULL) {
+        MPI_Comm_size(node.leader_comm, &node.num_nodes);
+        node.first_rank.resize(node.num_nodes);
+        node.node_sizes.resize(node.num_nodes);
+        MPI_Allgather(&first, 1, MPI_INT, node.first_rank.data(), 1, MPI_INT, node.leader_comm);
+        MPI_Allgather(&node.node_size, 1, MPI_INT, node.node_sizes.data(), 1, MPI_INT, node.leader_comm);
+    }
+    MPI_Bcast(&node.num_nodes, 1, MPI_INT, 0, node.node_comm);
+
+    return all_contiguous;
+}
+
+inline void node_fin(node_t &node) {
+    if (node.leader_comm != MPI_COMM_NULL) { MPI_Comm_free(&node.leader_comm); }
+    MPI_Comm_free(&node.node_comm);
+}
+
+// ---------------------------------------------------------------------
+// Helper: Shared Window Allocation
+// The node leader allocates 'count' elements for the whole node; the
+// other ranks attach to the same memory with MPI_Win_shared_query().
+// ---------------------------------------------------------------------
+template <typename T>
+T* shared_alloc(const node_t &node, const size_t count, MPI_Win &win) {
+    T *ptr = 0;
+    MPI_Aint size = node.node_rank ? 0 : count * sizeof(T);
+    MPI_Win_allocate_shared(size, sizeof(T), MPI_INFO_NULL, node.node_comm, &ptr, &win);
+
+    int disp_unit = 0;
+    MPI_Win_shared_query(win, 0, &size, &disp_unit, &ptr);
+    return ptr;
+}
+
+// ---------------------------------------------------------------------
+// Helper: Inter-node Exchange
+// Leaders gather every node's block of rows with MPI_Allgatherv. A node's
+// block is the union of its ranks' partition() slabs, which is contiguous
+// because its ranks are contiguous. Single-node runs send no messages.
+// ---------------------------------------------------------------------
+template <typename T>
+void exchange_nodes(std::complex<T> *data, const unsigned width, const unsigned height,
+                    const node_t &node, const int num_ranks) {
+    if (node.leader_comm == MPI_COMM_NULL || node.num_nodes == 1) { return; }
+
+    std::vector<int> counts(node.num_nodes), displs(node.num_nodes);
+    for (int n = 0; n < node.num_nodes; ++n) {
+        int first_start = 0, first_rows = 0, last_start = 0, last_rows = 0;
+        partition(height, num_ranks, node.first_rank[n], first_start, first_rows);
+        partition(height, num_ranks, node.first_rank[n] + node.node_sizes[n] - 1, last_start, last_rows);
+        displs[n] = first_start * width;
+        counts[n] = (last_start + last_rows - first_start) * width;
+    }
+    MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL,
+                   data, counts.data(), displs.data(), MPI_COMPLEX, node.leader_comm);
+}
+
+// ---------------------------------------------------------------------
+// Shared-Memory 2-D Discrete Fourier Transform
+// 'data' (height x width) and 'scratch' (the same size) live in one node
+// shared window 'win'. Row FFTs and both transposes work in place in
+// shared memory, each rank handling its partition() slab; window fences
+// order the phases. Only node leaders exchange MPI messages, so ranks on
+// the same node never copy rows to one another. On return every rank
+// sees the full result in 'data'.
+// ---------------------------------------------------------------------
+template <typename T>
+void dft2d_shared(std::complex<T> *data, std::complex<T> *scratch, MPI_Win win,
+                  const unsigned width, const unsigned height, const node_t &node,
+                  const int num_ranks, const int rank_id) {
+    fft_plan_t<T> row_plan(width), col_plan(height);
+    int my_start_row = 0, my_num_rows = 0;
+
+    // Make every rank's input rows visible.
+    MPI_Win_fence(0, win);
+
+    // --- Step a: Row-wise 1D DFT ---
+    partition(height, num_ranks, rank_id, my_start_row, my_num_rows);
+    for (int r = 0; r < my_num_rows; ++r) {
+        fft_1d_iterative(&data[(my_start_row + r) * width], row_plan);
+    }
+    MPI_Win_fence(0, win);
+    exchange_nodes(data, width, height, node, num_ranks);
+    MPI_Win_fence(0, win);
+
+    // --- Step b: Transpose into scratch, one slab of transposed rows per rank ---
+    partition(width, num_ranks, rank_id, my_start_row, my_num_rows);
+    for (int x = my_start_row; x < my_start_row + my_num_rows; ++x) {
+        for (unsigned y = 0; y < height; ++y) {
+            scratch[x * height + y] = data[y * width + x];
+        }
+    }
+
+    // --- Step c: Row-wise 1D DFT on the transposed slab ---
+    for (int r = 0; r < my_num_rows; ++r) {
+        fft_1d_iterative(&scratch[(my_start_row + r) * height], col_plan);
+    }
+    MPI_Win_fence(0, win);
+    exchange_nodes(scratch, height, width, node, num_ranks);
+    MPI_Win_fence(0, win);
+
+    // --- Step d: Transpose back into data ---
+    // Scratch is complete on every node, so the ranks of each node split all
+    // rows among themselves and every node ends up with the full result.
+    partition(height, node.node_size, node.node_rank, my_start_row, my_num_rows);
+    for (int y = my_start_row; y < my_start_row + my_num_rows; ++y) {
+        for (unsigned x = 0; x < width; ++x) {
+            data[y * width + x] = scratch[x * height + y];
+        }
+    }
+    MPI_Win_fence(0, win);
+}
+
+#endif
@@ -0,0 +1,136 @@
+/* stream.h */
+#ifndef __STREAM_H__
+#define __STREAM_H__
+
+#include <complex>
+#include <iostream>
+#include <mpi.h>
+#include <vector>
+#include "data.h"
+#include "dft.h"
+
+// ---------------------------------------------------------------------
+// Helper: Post the reads of one batch
+// Each rank reads its own row slab of every frame in the batch with
+// non-blocking MPI-IO, one request per frame.
+// ---------------------------------------------------------------------
+template <typename T>
+void post_reads(MPI_File fh, std::complex<T> *buffer, const unsigned first_frame, const unsigned frames,
+                const unsigned width, const unsigned height, const int my_start_row, const int my_num_rows,
+                std::vector<MPI_Request> &requests) {
+    const MPI_Offset frame_bytes = (MPI_Offset)width * height * sizeof(std::complex<T>);
+    requests.resize(frames);
+    for (unsigned f = 0; f < frames; ++f) {
+        MPI_Offset offset = sizeof(data_header_t) + (first_frame + f) * frame_bytes
+                          + (MPI_Offset)my_start_row * width * sizeof(std::complex<T>);
+        MPI_File_iread_at(fh, offset, &buffer[f * width * height + my_start_row * width],
+                          my_num_rows * width, MPI_COMPLEX, &requests[f]);
+    }
+}
+
+// ---------------------------------------------------------------------
+// Helper: Post the writes of one batch
+// Formats this rank's slab of every frame, finds the file offset of each
+// piece (frames in order, ranks in order within a frame) from an exclusive
+// prefix sum of the piece sizes, and posts non-blocking writes.
+// 'base' is the file offset of the batch and advances past it.
+// ---------------------------------------------------------------------
+template <typename T>
+void post_writes(MPI_File fh, std::complex<T> *buffer, std::vector<char> &text, const unsigned frames,
+                 const unsigned width, const unsigned height, const int my_start_row, const int my_num_rows,
+                 const bool binary, const int rank_id, long long &base, std::vector<MPI_Request> &requests) {
+    std::vector<long long> sizes(frames), offsets(frames, 0), totals(frames);
+    std::vector<size_t> starts(frames);
+
+    text.clear();
+    for (unsigned f = 0; f < frames; ++f) {
+        starts[f] = text.size();
+        format_rows(text, &buffer[f * width * height], width, height, my_start_row, my_num_rows,
+                    binary, !binary && !rank_id);
+        sizes[f] = text.size() - starts[f];
+    }
+    MPI_Exscan(sizes.data(), offsets.data(), frames, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(sizes.data(), totals.data(), frames, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    if (!rank_id) { std::fill(offsets.begin(), offsets.end(), 0); }
+
+    requests.resize(frames);
+    for (unsigned f = 0; f < frames; ++f) {
+        MPI_File_iwrite_at(fh, base + offsets[f], &text[starts[f]], sizes[f], MPI_CHAR, &requests[f]);
+        base += totals[f];
+    }
+}
+
+// ---------------------------------------------------------------------
+// Streaming Multi-Frame 2-D Discrete Fourier Transform
+// Transforms every frame of a binary input (depth = number of frames)
+// with one set of plans, 'batch' frames at a time. Batches run through a
+// three-stage pipeline: batch k+1 is read while batch k is transformed
+// and batch k-1 is written. Within a batch, collect_results() moves each
+// rank's slab of all frames in one message per peer, which amortizes
+// message latency for small frames. The output holds one write() image
+// per frame, or real32 magnitudes with 'binary'.
+// Returns the number of frames processed.
+// ---------------------------------------------------------------------
+template <typename T>
+unsigned dft2d_stream(const char *in_file, const char *out_file, const unsigned batch, const bool binary,
+                      const int num_ranks, const int rank_id) {
+    // Read the header.
+    MPI_File in = open_file(in_file, MPI_MODE_RDONLY, rank_id);
+    data_header_t header = read_header(in, in_file, rank_id);
+    const unsigned width = header.width, height = header.height, frames = header.depth;
+    const unsigned num_batches = (frames + batch - 1) / batch;
+
+    MPI_File out = open_file(out_file, MPI_MODE_CREATE|MPI_MODE_WRONLY, rank_id);
+    MPI_File_set_size(out, 0);
+    long long base = 0;
+    if (binary) {
+        data_header_t out_header = make_header(real32, width, height, frames);
+        if (!rank_id) { MPI_File_write_at(out, 0, &out_header, sizeof(out_header), MPI_BYTE, MPI_STATUS_IGNORE); }
+        base = sizeof(out_header);
+    }
+
+    // Plans and buffers stay alive for the whole stream.
+    fft_plan_t<T> row_plan(width), col_plan(height);
+    int my_start_row = 0, my_num_rows = 0;
+    partition(height, num_ranks, rank_id, my_start_row, my_num_rows);
+
+    std::vector<std::complex<T> > buffers[2];
+    std::vector<char> texts[2];
+    std::vector<MPI_Request> reads, writes[2];
+    for (int i = 0; i < 2; ++i) { buffers[i].resize((size_t)batch * width * height); }
+
+    // Prime the pipeline with the first batch.
+    if (num_batches) {
+        post_reads(in, buffers[0].data(), 0, std::min(batch, frames), width, height,
+                   my_start_row, my_num_rows, reads);
+    }
+
+    for (unsigned b = 0; b < num_batches; ++b) {
+        const unsigned first = b * batch, count = std::min(batch, frames - first);
+        std::complex<T> *current = buffers[b % 2].data();
+
+        // Batch b has arrived; start reading batch b+1 into the other buffer.
+        MPI_Waitall(reads.size(), reads.data(), MPI_STATUSES_IGNORE);
+        if (b + 1 < num_batches) {
+            post_reads(in, buffers[(b + 1) % 2].data(), first + count, std::min(batch, frames - first - count),
+                       width, height, my_start_row, my_num_rows, reads);
+        }
+
+        // Transform batch b while batch b-1 is being written.
+        dft2d_to_transposed(current, width, height, row_plan, col_plan, fft_forward, num_ranks, rank_id, count);
+        dft2d_transpose_back(current, width, height, num_ranks, rank_id, count);
+
+        // Batch b-2 has left texts[b % 2] before it is reused.
+        MPI_Waitall(writes[b % 2].size(), writes[b % 2].data(), MPI_STATUSES_IGNORE);
+        post_writes(out, current, texts[b % 2], count, width, height, my_start_row, my_num_rows,
+                    binary, rank_id, base, writes[b % 2]);
+    }
+
+    for (int i = 0; i < 2; ++i) { MPI_Waitall(writes[i].size(), writes[i].data(), MPI_STATUSES_IGNORE); }
+    MPI_File_close(&in);
+    MPI_File_close(&out);
+
+    return frames;
+}
+
+#endif
@@ -0,0 +1,53 @@
+#include <complex>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include "data.h"
+
+// Convert text data files into the binary format read by MPI-IO (see data.h).
+// Several input files of the same size become the frames of one binary file.
+template <typename T>
+void convert(char **text_files, const int num_files, const char *binary_file) {
+    // Open the file.
+    std::fstream fs;
+    fs.open(binary_file, std::fstream::out|std::fstream::binary);
+    if(!fs.is_open()) {
+        std::cerr << "Error: failed to open " << binary_file << std::endl;
+        exit(1);
+    }
+    unsigned frame_width = 0, frame_height = 0;
+    for(int i = 0; i < num_files; i++) {
+        T *data = 0;                        // Data array
+        unsigned width = 0, height = 0;     // Data dimension
+        read_text(text_files[i], data, width, height);
+        // The first frame fixes the header.
+        if(!i) {
+            data_header_t header = make_header(type_of(data), width, height, num_files);
+            fs.write((char*)&header, sizeof(header));
+            frame_width = width; frame_height = height;
+        }
+        else if((width != frame_width) || (height != frame_height)) {
+            std::cerr << "Error: " << text_files[i] << " does not match the first frame size" << std::endl;
+            exit(1);
+        }
+        fs.write((char*)data, sizeof(T) * width * height);
+        fin(data);
+    }
+    // Close the file.
+    fs.close();
+}
+
+int main(int argc, char **argv) {
+    bool real_input = (argc > 1) && !strcmp(argv[1], "-r");
+    int first = real_input ? 2 : 1;     // First text file
+    if(argc - first < 2) {              // Run command message
+        std::cerr << "Usage: " << argv[0] << " [-r] <text_file>... <binary_file>" << std::endl
+                  << "  -r  store real parts only (real32) for the r2c path" << std::endl;
+        exit(1);
+    }
+
+    if(real_input) { convert<float>(&argv[first], argc - first - 1, argv[argc - 1]); }
+    else           { convert<std::complex<float> >(&argv[first], argc - first - 1, argv[argc - 1]); }
+
+    return 0;
+}
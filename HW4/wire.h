@@ -0,0 +1,151 @@
+/* wire.h */
+#ifndef __WIRE_H__
+#define __WIRE_H__
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <mpi.h>
+#include <vector>
+#include "data.h"
+
+// ---------------------------------------------------------------------
+// Wire Formats
+// How collect_results() sends rows to the other ranks. Both reduced
+// formats take 4 bytes per complex value instead of 8.
+//   wire_fp32: MPI_COMPLEX, exact.
+//   wire_bf16: the upper half of each fp32 part, rounded to nearest even.
+//              Relative error <= 2^-9 (0.2%) of each real/imaginary part,
+//              with the full fp32 exponent range.
+//   wire_bfp:  block floating point, one exponent per row and a 16-bit
+//              signed mantissa per part. Absolute error <= 2^-15 (0.003%)
+//              of the row's largest part; small parts next to a large one
+//              lose relative accuracy.
+// fp16 is not offered: unnormalized FFT rows exceed its 65504 maximum.
+// An error introduced before the column DFT spreads over a column of
+// 'height' values, so the final error can grow by up to 'height' times
+// the bound above (about sqrt(height) times for uncorrelated rounding).
+// ---------------------------------------------------------------------
+enum wire_format { wire_fp32 = 0, wire_bf16, wire_bfp };
+inline wire_format fft_wire = wire_fp32;
+
+// Parse a wire format name.
+inline bool parse_wire_format(const char *name, wire_format &format) {
+         if(!strcmp(name, "fp32")) { format = wire_fp32; }
+    else if(!strcmp(name, "bf16")) { format = wire_bf16; }
+    else if(!strcmp(name, "bfp"))  { format = wire_bfp;  }
+    else { return false; }
+    return true;
+}
+
+inline uint16_t to_bf16(const float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    if(std::isnan(value)) { return (bits >> 16) | 0x40; }  // Keep NaNs quiet
+    bits += 0x7fff + ((bits >> 16) & 1);                    // Round to nearest even
+    return bits >> 16;
+}
+
+inline float from_bf16(const uint16_t half) {
+    uint32_t bits = (uint32_t)half << 16;
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// 16-bit words in one packed row of 'width' complex values
+inline size_t packed_row_words(const unsigned width, const wire_format format) {
+    return (format == wire_bfp ? 1 : 0) + 2 * (size_t)width;
+}
+
+// ---------------------------------------------------------------------
+// Helper: Pack and Unpack One Row
+// ---------------------------------------------------------------------
+template <typename T>
+void pack_row(const std::complex<T> *row, const unsigned width, const wire_format format, uint16_t *out) {
+    if(format == wire_bf16) {
+        for(unsigned x = 0; x < width; x++) {
+            out[2 * x]     = to_bf16(row[x].real());
+            out[2 * x + 1] = to_bf16(row[x].imag());
+        }
+        return;
+    }
+
+    // Shared exponent: every part of the row is below 2^exponent.
+    T max = 0;
+    for(unsigned x = 0; x < width; x++) {
+        max = std::max(max, std::max(std::abs(row[x].real()), std::abs(row[x].imag())));
+    }
+    int exponent = 0;
+    if(std::isfinite(max) && (max > 0)) { std::frexp(max, &exponent); }
+    const T scale = std::ldexp(T(1), 15 - exponent);
+    out[0] = (uint16_t)(int16_t)exponent;
+    for(unsigned x = 0; x < width; x++) {
+        out[1 + 2 * x] = (uint16_t)(int16_t)std::max(-32767L, std::min(32767L, std::lrint(row[x].real() * scale)));
+        out[2 + 2 * x] = (uint16_t)(int16_t)std::max(-32767L, std::min(32767L, std::lrint(row[x].imag() * scale)));
+    }
+}
+
+template <typename T>
+void unpack_row(const uint16_t *in, const unsigned width, const wire_format format, std::complex<T> *row) {
+    if(format == wire_bf16) {
+        for(unsigned x = 0; x < width; x++) {
+            row[x] = std::complex<T>(from_bf16(in[2 * x]), from_bf16(in[2 * x + 1]));
+        }
+        return;
+    }
+
+    const T scale = std::ldexp(T(1), (int16_t)in[0] - 15);
+    for(unsigned x = 0; x < width; x++) {
+        row[x] = std::complex<T>((int16_t)in[1 + 2 * x] * scale, (int16_t)in[2 + 2 * x] * scale);
+    }
+}
+
+// ---------------------------------------------------------------------
+// Helper: Compressed Allgather
+// Same exchange as collect_results(), with every rank's slab (of every
+// frame) packed once in fft_wire format and unpacked on arrival. A rank
+// also unpacks its own slab, so all ranks hold identical matrices.
+// ---------------------------------------------------------------------
+template <typename T>
+void collect_packed(std::complex<T> *data, const unsigned width, const unsigned height,
+                    const int num_ranks, const int my_rank, const int my_start_row, const int my_num_rows,
+                    const unsigned frames) {
+    const size_t row_words = packed_row_words(width, fft_wire), frame_size = (size_t)width * height;
+
+    std::vector<uint16_t> send(frames * my_num_rows * row_words);
+    for(unsigned f = 0; f < frames; f++) {
+        for(int r = 0; r < my_num_rows; r++) {
+            pack_row(&data[f * frame_size + (my_start_row + r) * width], width, fft_wire,
+                     &send[(f * my_num_rows + r) * row_words]);
+        }
+    }
+
+    std::vector<std::vector<uint16_t> > recv(num_ranks);
+    std::vector<MPI_Request> requests(num_ranks);
+    for(int r = 0; r < num_ranks; r++) {
+        int r_start = 0, r_rows = 0;
+        partition(height, num_ranks, r, r_start, r_rows);
+        recv[r].resize(frames * r_rows * row_words);
+        MPI_Irecv(recv[r].data(), recv[r].size(), MPI_UINT16_T, r, 0, MPI_COMM_WORLD, &requests[r]);
+    }
+    for(int r = 0; r < num_ranks; r++) {
+        MPI_Send(send.data(), send.size(), MPI_UINT16_T, r, 0, MPI_COMM_WORLD);
+    }
+    MPI_Waitall(num_ranks, requests.data(), MPI_STATUSES_IGNORE);
+
+    for(int r = 0; r < num_ranks; r++) {
+        int r_start = 0, r_rows = 0;
+        partition(height, num_ranks, r, r_start, r_rows);
+        for(unsigned f = 0; f < frames; f++) {
+            for(int y = 0; y < r_rows; y++) {
+                unpack_row(&recv[r][(f * r_rows + y) * row_words], width, fft_wire,
+                           &data[f * frame_size + (r_start + y) * width]);
+            }
+        }
+    }
+}
+
+#endif
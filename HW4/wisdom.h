@@ -0,0 +1,106 @@
+#ifndef __WISDOM_H__
+#define __WISDOM_H__
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Planner modes: heuristic defaults, measure if not in the wisdom file,
+// or use the wisdom file without ever measuring.
+enum wisdom_mode { wisdom_estimate = 0, wisdom_measure, wisdom_load };
+
+// Parse a planner mode name.
+inline bool parse_wisdom_mode(const char *name, wisdom_mode &mode) {
+         if(!strcmp(name, "estimate")) { mode = wisdom_estimate; }
+    else if(!strcmp(name, "measure"))  { mode = wisdom_measure;  }
+    else if(!strcmp(name, "load"))     { mode = wisdom_load;     }
+    else { return false; }
+    return true;
+}
+
+// CPU model name from /proc/cpuinfo, so that wisdom from another host type is never reused.
+inline std::string cpu_model() {
+    std::ifstream fs("/proc/cpuinfo");
+    std::string line;
+    while(std::getline(fs, line)) {
+        if(!line.compare(0, 10, "model name")) {
+            size_t colon = line.find(':');
+            if(colon != std::string::npos) {
+                size_t begin = line.find_first_not_of(" \t", colon + 1);
+                return begin == std::string::npos ? "unknown" : line.substr(begin);
+            }
+        }
+    }
+    return "unknown";
+}
+
+// Best wall-clock time of 'reps' runs of 'f' in milliseconds
+template <typename F>
+double best_time(F f, const unsigned reps) {
+    double best = 0.0;
+    for(unsigned i = 0; i < reps; i++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        f();
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if(!i || (elapsed < best)) { best = elapsed; }
+    }
+    return best;
+}
+
+// Tuned parameters persisted to disk. Every line of a wisdom file is
+// "<cpu model>|<problem>" followed by a tab and the chosen values.
+class wisdom_t {
+public:
+    wisdom_t() { }
+    // Load a wisdom file; a missing file is an empty wisdom.
+    bool load(const char *file_name) {
+        std::ifstream fs(file_name);
+        if(!fs.is_open()) { return false; }
+        std::string line;
+        while(std::getline(fs, line)) {
+            size_t tab = line.find('\t');
+            if(tab == std::string::npos) { continue; }
+            std::istringstream values(line.substr(tab + 1));
+            std::vector<long> &entry = entries[line.substr(0, tab)];
+            entry.clear();
+            for(long value; values >> value;) { entry.push_back(value); }
+        }
+        return true;
+    }
+    // Store all entries, replacing the file.
+    bool save(const char *file_name) const {
+        std::ofstream fs(file_name);
+        if(!fs.is_open()) {
+            std::cerr << "Warning: failed to save " << file_name << std::endl; return false;
+        }
+        for(std::map<std::string, std::vector<long> >::const_iterator it = entries.begin(); it != entries.end(); it++) {
+            fs << it->first << '\t';
+            for(size_t i = 0; i < it->second.size(); i++) { fs << (i ? " " : "") << it->second[i]; }
+            fs << std::endl;
+        }
+        return true;
+    }
+    // Find the values chosen for a problem on this host type.
+    bool lookup(const std::string &problem, std::vector<long> &values) const {
+        std::map<std::string, std::vector<long> >::const_iterator it = entries.find(key(problem));
+        if(it == entries.end()) { return false; }
+        values = it->second;
+        return true;
+    }
+    // Record the values chosen for a problem on this host type.
+    void store(const std::string &problem, const std::vector<long> &values) { entries[key(problem)] = values; }
+
+private:
+    static std::string key(const std::string &problem) { return cpu_model() + "|" + problem; }
+
+    std::map<std::string, std::vector<long> > entries;
+};
+
+#endif
+